@@ -97,6 +97,26 @@ public:
 	}
 
 
+	// the world space rectangle currently visible through the view, grown by margin world units on every side
+	[[nodiscard]] sf::FloatRect get_view_bounds(const float margin = 0.f) const
+	{
+		const sf::Vector2f size = m_view_.getSize();
+		const sf::Vector2f center = m_view_.getCenter();
+		return { center.x - size.x / 2.f - margin, center.y - size.y / 2.f - margin,
+				 size.x + margin * 2.f, size.y + margin * 2.f };
+	}
+
+
+	// fills visible_ids with every object stored in the grid cells overlapping the view, use the margin
+	// to cover entities whose position is off screen but whose shape still reaches into it
+	template<typename Grid, typename Container>
+	void collect_visible(const Grid& grid, Container& visible_ids, const float margin = 0.f) const
+	{
+		visible_ids.clear();
+		grid.query_rect(get_view_bounds(margin), visible_ids);
+	}
+
+
 	
 private:
 	void update_window_view() const
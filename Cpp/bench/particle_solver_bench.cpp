@@ -0,0 +1,72 @@
+/*
+	particle_solver_bench
+- times ParticleSolver::step() on toroidal worlds of 10k, 100k and 1M particles and prints steps / sec
+- every world keeps about 2.5 particles per cell, well under the 24 a cell holds, with cells 4 units wide for radius 1
+  particles so a cell is at least 2 * radius
+- cell counts are multiples of 3 and 2 so the collision pass stays parallel across the toroidal seam
+- the thread count defaults to std::thread::hardware_concurrency(), pass another as the first argument
+
+	c++ -O3 -std=c++20 -pthread -I<SFML>/include particle_solver_bench.cpp -o particle_solver_bench
+	./particle_solver_bench 8
+*/
+
+#define SPATIAL_GRID_NO_GRAPHICS
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+
+#include "../particle_solver.h"
+
+static constexpr float radius = 1.f;
+static constexpr float cell_size = 4.f;
+static constexpr float dt = 1.f / 60.f;
+
+
+template<size_t Cells>
+static void bench(const size_t particle_count, const unsigned thread_count)
+{
+	const float world_size = Cells * cell_size;
+	ParticleSolver<Cells, Cells> solver({ world_size, world_size }, radius, thread_count);
+	solver.toroidal = true;
+
+	std::mt19937 rng(1);
+	std::uniform_real_distribution<float> position(0.f, world_size);
+	std::uniform_real_distribution<float> velocity(-20.f, 20.f);
+
+	solver.reserve(particle_count);
+	for (size_t i = 0; i < particle_count; ++i)
+		solver.add_particle({ position(rng), position(rng) }, { velocity(rng), velocity(rng) });
+
+	// the first steps push the random start apart, they aren't representative
+	for (int i = 0; i < 10; ++i)
+		solver.step(dt);
+
+	// run for at least half a second so the small worlds get enough steps to time
+	size_t steps = 0;
+	const auto start = std::chrono::steady_clock::now();
+	double seconds = 0.0;
+	while (seconds < 0.5 || steps < 5)
+	{
+		solver.step(dt);
+		++steps;
+		seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	std::printf("%8zu particles, %4zu x %-4zu cells: %9.1f steps/sec (%.3f ms/step)\n",
+		particle_count, Cells, Cells, steps / seconds, seconds * 1000.0 / steps);
+}
+
+
+int main(const int argc, char** argv)
+{
+	const unsigned thread_count = argc > 1 ? static_cast<unsigned>(std::atoi(argv[1])) : std::thread::hardware_concurrency();
+	std::printf("%u threads, 1 substep per step\n", thread_count);
+
+	bench<66>(10'000, thread_count);
+	bench<198>(100'000, thread_count);
+	bench<630>(1'000'000, thread_count);
+	return EXIT_SUCCESS;
+}
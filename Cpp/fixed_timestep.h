@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+#include "stop_watch.h"
+
+/*
+	FixedTimestep
+- decouples the simulation from the frame rate: real time is accumulated and the simulation is stepped in fixed dt slices
+- at most max_substeps steps are taken per frame, any further backlog is dropped so a slow frame can't snowball (spiral of death)
+- alpha() is how far real time is between the last two simulation states, render with interpolate(previous, current, alpha())
+- headless mode ignores real time and runs a fixed number of steps per presented frame, for batch runs
+
+	FixedTimestep timestep(1.0 / 60.0);
+	while (running)
+	{
+		timestep.advance([&](const double dt) { simulation.update(dt); });
+		renderer.draw(simulation, timestep.alpha());
+	}
+*/
+
+class FixedTimestep
+{
+	StopWatch stop_watch_;
+
+	double timestep_;
+	unsigned max_substeps_;
+
+	double accumulator_ = 0.0;
+	double alpha_ = 0.0;
+
+	bool headless_ = false;
+	unsigned headless_steps_per_frame_ = 1;
+
+	uint64_t total_steps_ = 0;
+	double dropped_time_ = 0.0;
+
+public:
+	explicit FixedTimestep(const double timestep_seconds = 1.0 / 60.0, const unsigned max_substeps = 5)
+		: timestep_(timestep_seconds), max_substeps_(max_substeps == 0 ? 1 : max_substeps) {}
+
+
+	// calls step(dt) once per fixed step owed since the previous call, returns how many steps were taken
+	template<typename StepFunc>
+	unsigned advance(StepFunc&& step)
+	{
+		if (headless_)
+		{
+			for (unsigned i = 0; i < headless_steps_per_frame_; ++i)
+			{
+				step(timestep_);
+			}
+
+			stop_watch_.get_delta(); // keeps real time from piling up for when headless mode is switched off
+			total_steps_ += headless_steps_per_frame_;
+			alpha_ = 1.0;
+			return headless_steps_per_frame_;
+		}
+
+		accumulator_ += stop_watch_.get_delta();
+
+		unsigned steps = 0;
+		while (accumulator_ >= timestep_ && steps < max_substeps_)
+		{
+			step(timestep_);
+			accumulator_ -= timestep_;
+			++steps;
+		}
+
+		// spiral of death guard, whatever the substep limit couldn't catch up on is dropped
+		if (accumulator_ >= timestep_)
+		{
+			const double remainder = std::fmod(accumulator_, timestep_);
+			dropped_time_ += accumulator_ - remainder;
+			accumulator_ = remainder;
+		}
+
+		total_steps_ += steps;
+		alpha_ = accumulator_ / timestep_;
+		return steps;
+	}
+
+	// runs steps_per_frame simulation steps on every advance() regardless of real time, 0 turns headless mode off
+	void set_headless(const unsigned steps_per_frame)
+	{
+		headless_ = steps_per_frame > 0;
+		headless_steps_per_frame_ = steps_per_frame;
+		reset();
+	}
+
+	// forget any accumulated time, call after a pause (loading, window dragging) to avoid a burst of catch up steps
+	void reset()
+	{
+		stop_watch_.get_delta();
+		accumulator_ = 0.0;
+		alpha_ = headless_ ? 1.0 : 0.0;
+	}
+
+	void set_timestep(const double timestep_seconds) { timestep_ = timestep_seconds; }
+	void set_max_substeps(const unsigned max_substeps) { max_substeps_ = max_substeps == 0 ? 1 : max_substeps; }
+
+	[[nodiscard]] double timestep() const { return timestep_; }
+	[[nodiscard]] double alpha() const { return alpha_; }
+	[[nodiscard]] bool is_headless() const { return headless_; }
+	[[nodiscard]] uint64_t total_steps() const { return total_steps_; }
+
+	// total real time in seconds the simulation has skipped due to the substep limit
+	[[nodiscard]] double dropped_time() const { return dropped_time_; }
+};
+
+
+// blends the previous and current simulation state for rendering, works for floats and sf::Vector2 alike
+template<typename T>
+T interpolate(const T& previous, const T& current, const double alpha)
+{
+	return previous + (current - previous) * static_cast<float>(alpha);
+}
@@ -1,16 +1,21 @@
 #pragma once
 #include <SFML/Graphics.hpp>
 #include <iostream>
+#include <string_view>
+
+#include "text_batch.h"
 
 class Font
 {
     sf::Font m_font_;
     sf::Text m_text_;
     sf::RenderWindow* m_window_;
+    TextBatch m_batch_;
 
 public:
     // Constructor taking font size and file location
-    Font(sf::RenderWindow* window, const unsigned font_size, const std::string& font_location) : m_window_(window)
+    Font(sf::RenderWindow* window, const unsigned font_size, const std::string& font_location)
+        : m_window_(window), m_batch_(m_font_, font_size)
     {
         if (!m_font_.loadFromFile(font_location))
         {
@@ -27,6 +32,7 @@ public:
     void set_font_size(const unsigned font_size)
     {
         m_text_.setCharacterSize(font_size);
+        m_batch_.set_character_size(font_size);
     }
 
     // Function to draw text on the window
@@ -48,4 +54,17 @@ public:
         m_text_.setPosition(text_position);
         m_window_->draw(m_text_);
     }
+
+    // Function to queue text for draw_batched_text(), layouts of repeated strings are cached
+    void draw_batched(const sf::Vector2f& position, const std::string_view string_text, const bool centered = false,
+        const sf::Color color = sf::Color::White)
+    {
+        m_batch_.add(position, string_text, color, centered);
+    }
+
+    // Function to draw every queued text on the window with one draw call
+    void draw_batched_text()
+    {
+        m_batch_.flush(*m_window_);
+    }
 };
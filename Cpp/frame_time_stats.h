@@ -0,0 +1,265 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+
+/*
+	FrameTimeStats
+- records frame (or subsystem) durations in nanoseconds over a sliding window of the last WindowSize samples
+- mean and variance of the window are kept as running sums, so adding a sample is O(1)
+- percentiles come from a log bucketed histogram of the same window, the precision is 1 / 2^SubBucketBits (~3% by default)
+- call tick() once per frame, or wrap a subsystem in a ScopedSample to time it
+*/
+
+
+// HDR style histogram: values are grouped by their power of two, each power is split into 2^SubBucketBits linear buckets
+// values of 2^MaxValueBits and above are clamped into the last bucket (2^40ns is roughly 18 minutes)
+template<unsigned SubBucketBits = 5, unsigned MaxValueBits = 40>
+class LogHistogram
+{
+	static_assert(SubBucketBits < MaxValueBits && MaxValueBits < 64);
+
+public:
+	static constexpr uint64_t sub_bucket_count = uint64_t{ 1 } << SubBucketBits;
+	static constexpr uint64_t max_value = (uint64_t{ 1 } << MaxValueBits) - 1;
+	static constexpr size_t bucket_count = (MaxValueBits - SubBucketBits + 1) * sub_bucket_count;
+
+private:
+	std::array<uint32_t, bucket_count> counts_{};
+	uint64_t total_ = 0;
+
+public:
+	static size_t bucket_index(uint64_t value)
+	{
+		value = std::min(value, max_value);
+		if (value < sub_bucket_count)
+			return static_cast<size_t>(value);
+
+		const unsigned exponent = static_cast<unsigned>(std::bit_width(value)) - SubBucketBits - 1;
+		return static_cast<size_t>(exponent * sub_bucket_count + (value >> exponent));
+	}
+
+	// the smallest value which lands in the given bucket
+	static uint64_t bucket_lowest_value(const size_t index)
+	{
+		if (index < sub_bucket_count)
+			return index;
+
+		const uint64_t exponent = index / sub_bucket_count - 1;
+		return (index - exponent * sub_bucket_count) << exponent;
+	}
+
+	// the largest value which lands in the given bucket
+	static uint64_t bucket_highest_value(const size_t index)
+	{
+		return index + 1 < bucket_count ? bucket_lowest_value(index + 1) - 1 : max_value;
+	}
+
+	void add(const uint64_t value)
+	{
+		++counts_[bucket_index(value)];
+		++total_;
+	}
+
+	void remove(const uint64_t value)
+	{
+		--counts_[bucket_index(value)];
+		--total_;
+	}
+
+	void clear()
+	{
+		counts_.fill(0);
+		total_ = 0;
+	}
+
+	[[nodiscard]] uint64_t total() const { return total_; }
+
+	// fraction in [0, 1], returns the highest value of the bucket holding that rank so tails are never under reported
+	[[nodiscard]] uint64_t percentile(const double fraction) const
+	{
+		if (total_ == 0)
+			return 0;
+
+		const auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(std::clamp(fraction, 0.0, 1.0) * static_cast<double>(total_))));
+
+		uint64_t seen = 0;
+		for (size_t i = 0; i < bucket_count; ++i)
+		{
+			seen += counts_[i];
+			if (seen >= rank)
+				return bucket_highest_value(i);
+		}
+		return max_value;
+	}
+};
+
+
+template<size_t WindowSize>
+class FrameTimeStats
+{
+	static_assert(WindowSize > 0);
+
+	std::array<uint64_t, WindowSize> samples_{};
+	size_t current_index_ = 0;
+	size_t current_size_ = 0;
+
+	LogHistogram<> histogram_;
+	uint64_t window_sum_ns_ = 0;
+	double window_sum_sq_ms_ = 0.0;
+
+	// the histogram only knows the max to within its bucket, so the exact one is tracked alongside
+	uint64_t window_max_ns_ = 0;
+
+	// lifetime statistics (Welford)
+	uint64_t lifetime_count_ = 0;
+	double lifetime_mean_ms_ = 0.0;
+	double lifetime_m2_ = 0.0;
+
+	std::chrono::steady_clock::time_point last_tick_time_;
+
+public:
+	FrameTimeStats() : last_tick_time_(std::chrono::steady_clock::now()) {}
+
+	// records the time since the previous call, call once per frame
+	void tick()
+	{
+		const auto current_time = std::chrono::steady_clock::now();
+		add_sample(current_time - last_tick_time_);
+		last_tick_time_ = current_time;
+	}
+
+	void add_sample(const std::chrono::nanoseconds duration)
+	{
+		add_sample_ns(static_cast<uint64_t>(std::max<int64_t>(0, duration.count())));
+	}
+
+	void add_sample_ns(const uint64_t sample_ns)
+	{
+		bool evicted_max = false;
+		if (current_size_ == WindowSize)
+		{
+			const uint64_t evicted = samples_[current_index_];
+			histogram_.remove(evicted);
+			window_sum_ns_ -= evicted;
+			window_sum_sq_ms_ -= to_ms(evicted) * to_ms(evicted);
+			evicted_max = evicted == window_max_ns_;
+		}
+		else
+		{
+			++current_size_;
+		}
+
+		samples_[current_index_] = sample_ns;
+		histogram_.add(sample_ns);
+		window_sum_ns_ += sample_ns;
+		window_sum_sq_ms_ += to_ms(sample_ns) * to_ms(sample_ns);
+
+		// only a rescan when the max itself leaves the window
+		if (evicted_max && sample_ns < window_max_ns_)
+			window_max_ns_ = *std::max_element(samples_.begin(), samples_.end());
+		else
+			window_max_ns_ = std::max(window_max_ns_, sample_ns);
+
+		current_index_ = (current_index_ + 1) % WindowSize;
+
+		// the squared sum drifts with every add / subtract, resyncing once per window keeps it exact at amortised O(1)
+		if (current_index_ == 0)
+			resync_window_sum_sq();
+
+		++lifetime_count_;
+		const double delta = to_ms(sample_ns) - lifetime_mean_ms_;
+		lifetime_mean_ms_ += delta / static_cast<double>(lifetime_count_);
+		lifetime_m2_ += delta * (to_ms(sample_ns) - lifetime_mean_ms_);
+	}
+
+	[[nodiscard]] size_t sample_count() const { return current_size_; }
+
+	[[nodiscard]] double mean_ms() const
+	{
+		if (current_size_ == 0) return 0.0;
+		return to_ms(window_sum_ns_) / static_cast<double>(current_size_);
+	}
+
+	[[nodiscard]] double variance_ms() const
+	{
+		if (current_size_ == 0) return 0.0;
+		const double mean = mean_ms();
+		return std::max(0.0, window_sum_sq_ms_ / static_cast<double>(current_size_) - mean * mean);
+	}
+
+	[[nodiscard]] double stddev_ms() const { return std::sqrt(variance_ms()); }
+
+	// average frame rate over the window, frames divided by the time they took
+	[[nodiscard]] double fps() const
+	{
+		const double mean = mean_ms();
+		return mean > 0.0 ? 1000.0 / mean : 0.0;
+	}
+
+	// fraction in [0, 1] e.g. 0.99 for the 99th percentile frame time
+	// the histogram gives the top edge of a bucket, which is clamped to the exact window max so no percentile exceeds it
+	[[nodiscard]] double percentile_ms(const double fraction) const
+	{
+		return to_ms(std::min(histogram_.percentile(fraction), window_max_ns_));
+	}
+	[[nodiscard]] double p50_ms() const { return percentile_ms(0.50); }
+	[[nodiscard]] double p95_ms() const { return percentile_ms(0.95); }
+	[[nodiscard]] double p99_ms() const { return percentile_ms(0.99); }
+	[[nodiscard]] double max_ms() const { return to_ms(window_max_ns_); }
+
+	[[nodiscard]] uint64_t lifetime_count() const { return lifetime_count_; }
+	[[nodiscard]] double lifetime_mean_ms() const { return lifetime_mean_ms_; }
+	[[nodiscard]] double lifetime_stddev_ms() const
+	{
+		if (lifetime_count_ < 2) return 0.0;
+		return std::sqrt(lifetime_m2_ / static_cast<double>(lifetime_count_ - 1));
+	}
+
+	void reset()
+	{
+		current_index_ = 0;
+		current_size_ = 0;
+		histogram_.clear();
+		window_sum_ns_ = 0;
+		window_sum_sq_ms_ = 0.0;
+		window_max_ns_ = 0;
+		lifetime_count_ = 0;
+		lifetime_mean_ms_ = 0.0;
+		lifetime_m2_ = 0.0;
+		last_tick_time_ = std::chrono::steady_clock::now();
+	}
+
+private:
+	static double to_ms(const uint64_t nanoseconds)
+	{
+		return static_cast<double>(nanoseconds) * 1e-6;
+	}
+
+	void resync_window_sum_sq()
+	{
+		window_sum_sq_ms_ = 0.0;
+		for (size_t i = 0; i < current_size_; ++i)
+			window_sum_sq_ms_ += to_ms(samples_[i]) * to_ms(samples_[i]);
+	}
+};
+
+
+// times the enclosing scope into a FrameTimeStats, useful for per subsystem statistics
+template<typename Stats>
+class ScopedSample
+{
+	Stats& stats_;
+	std::chrono::steady_clock::time_point start_;
+
+public:
+	explicit ScopedSample(Stats& stats) : stats_(stats), start_(std::chrono::steady_clock::now()) {}
+	~ScopedSample() { stats_.add_sample(std::chrono::steady_clock::now() - start_); }
+
+	ScopedSample(const ScopedSample&) = delete;
+	ScopedSample& operator=(const ScopedSample&) = delete;
+};
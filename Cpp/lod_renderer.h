@@ -0,0 +1,125 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+#include <array>
+#include <vector>
+
+#include "Camera.h"
+#include "spatial_grid.h"
+
+/*
+	LodRenderer
+- below zoom_threshold (Camera::m_currentScroll) entities stop being drawn one by one and the grid is shown as a density heatmap instead
+- the heatmap is one pixel per grid cell built from SpatialGrid::objects_count, drawn as a single textured quad
+- the cost of the zoomed out view depends only on the number of cells, not on the number of entities
+
+	LodRenderer<CellsX, CellsY> lod(grid, 0.2f);
+	lod.render(window, camera, grid, [&] { draw_entities(window); });
+*/
+
+template<size_t CellsX, size_t CellsY>
+class LodRenderer
+{
+	float zoom_threshold_;
+
+	std::array<sf::Color, cell_capacity> palette_{};
+	std::vector<sf::Uint8> pixels_;
+	sf::Texture texture_;
+	sf::VertexArray quad_{ sf::TriangleStrip, 4 };
+
+public:
+	// empty cells are drawn transparent, cells fade from low_density to high_density as they fill up
+	explicit LodRenderer(const SpatialGrid<CellsX, CellsY>& grid, const float zoom_threshold = 0.2f,
+		const sf::Color low_density = { 20, 40, 120 }, const sf::Color high_density = { 255, 220, 60 })
+		: zoom_threshold_(zoom_threshold), pixels_(CellsX * CellsY * 4, 0)
+	{
+		texture_.create(static_cast<unsigned>(CellsX), static_cast<unsigned>(CellsY));
+		texture_.setSmooth(false);
+
+		set_palette(low_density, high_density);
+		init_quad(grid);
+	}
+
+
+	[[nodiscard]] bool use_heatmap(const Camera& camera) const
+	{
+		return camera.m_currentScroll < zoom_threshold_;
+	}
+
+	void set_zoom_threshold(const float zoom_threshold) { zoom_threshold_ = zoom_threshold; }
+
+
+	// draws the heatmap when zoomed out past the threshold, otherwise calls draw_entities
+	template<typename DrawEntities>
+	void render(sf::RenderTarget& target, const Camera& camera, const SpatialGrid<CellsX, CellsY>& grid,
+		DrawEntities&& draw_entities, const sf::RenderStates& render_states = sf::RenderStates())
+	{
+		if (!use_heatmap(camera))
+		{
+			draw_entities();
+			return;
+		}
+
+		update(grid);
+		draw(target, render_states);
+	}
+
+
+	// rebuilds the heatmap texture from the current cell counts
+	void update(const SpatialGrid<CellsX, CellsY>& grid)
+	{
+		for (size_t i = 0; i < CellsX * CellsY; ++i)
+		{
+			const sf::Color& color = palette_[grid.objects_count[i]];
+			sf::Uint8* pixel = &pixels_[i * 4];
+			pixel[0] = color.r;
+			pixel[1] = color.g;
+			pixel[2] = color.b;
+			pixel[3] = color.a;
+		}
+
+		texture_.update(pixels_.data());
+	}
+
+	void draw(sf::RenderTarget& target, sf::RenderStates render_states = sf::RenderStates()) const
+	{
+		render_states.texture = &texture_;
+		target.draw(quad_, render_states);
+	}
+
+
+	void set_palette(const sf::Color low_density, const sf::Color high_density)
+	{
+		const auto lerp = [](const sf::Uint8 a, const sf::Uint8 b, const float t)
+		{
+			return static_cast<sf::Uint8>(static_cast<float>(a) + (static_cast<float>(b) - static_cast<float>(a)) * t);
+		};
+
+		palette_[0] = sf::Color::Transparent;
+		for (size_t count = 1; count < cell_capacity; ++count)
+		{
+			const float t = static_cast<float>(count - 1) / static_cast<float>(cell_capacity - 2);
+			palette_[count] = {
+				lerp(low_density.r, high_density.r, t),
+				lerp(low_density.g, high_density.g, t),
+				lerp(low_density.b, high_density.b, t),
+				lerp(low_density.a, high_density.a, t) };
+		}
+	}
+
+private:
+	// covers the same world area the grid hashes into, one texel per cell
+	void init_quad(const SpatialGrid<CellsX, CellsY>& grid)
+	{
+		const float width = grid.m_cellSize.x * static_cast<float>(CellsX);
+		const float height = grid.m_cellSize.y * static_cast<float>(CellsY);
+		const auto cells_x = static_cast<float>(CellsX);
+		const auto cells_y = static_cast<float>(CellsY);
+
+		quad_[0] = sf::Vertex({ 0.f, 0.f }, { 0.f, 0.f });
+		quad_[1] = sf::Vertex({ width, 0.f }, { cells_x, 0.f });
+		quad_[2] = sf::Vertex({ 0.f, height }, { 0.f, cells_y });
+		quad_[3] = sf::Vertex({ width, height }, { cells_x, cells_y });
+	}
+};
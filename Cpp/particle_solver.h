@@ -0,0 +1,324 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "spatial_grid.h"
+#include "thread_pool.h"
+
+/*
+	ParticleSolver
+- Verlet integrated circles of one radius, stored as structure of arrays
+- SpatialGrid is the broad phase, each cell is checked against itself and its right / lower neighbours only
+- collisions push overlapping particles apart and exchange their normal velocities (restitution 1 is perfectly elastic)
+- the cells are solved in 6 colours (x % 3, y % 2): no two cells of one colour touch the same particles,
+  so each colour is solved in parallel without locks
+- bounded worlds bounce particles off the edges, toroidal worlds wrap them around
+- toroidal worlds need CellsX % 3 == 0 and CellsY % 2 == 0 for the colouring to hold across the seam, otherwise
+  the collision pass runs on one thread
+- the grid is built without padding so its cells tile the world exactly, which the toroidal seam relies on
+- a grid cell must be at least 2 * radius wide, and holds at most cell_capacity - 1 particles
+- velocities are in world units per second, the Verlet state stores the displacement over one sub-step,
+  step() rescales it when dt / substeps changes so a particle moves the same distance for any substep count
+- for a headless solver define SPATIAL_GRID_NO_GRAPHICS, the grid then skips loading its debug font and vertex buffer
+
+	ParticleSolver<128, 128> solver({ 1000.f, 1000.f }, 3.f);
+	solver.add_particle({ 10.f, 10.f }, { 60.f, 0.f }); // moves 1 unit per 1 / 60 s step
+	solver.step(1.f / 60.f, 4);
+*/
+
+template<size_t CellsX, size_t CellsY>
+class ParticleSolver
+{
+	static_assert(CellsX >= 3 && CellsY >= 3, "ParticleSolver needs at least 3 cells per axis");
+
+public:
+	std::vector<float> position_x;
+	std::vector<float> position_y;
+	std::vector<float> previous_x;
+	std::vector<float> previous_y;
+
+	sf::Vector2f gravity{};
+	float restitution = 1.f;      // between particles
+	float wall_restitution = 1.f; // against the world edges, bounded worlds only
+	bool toroidal = false;
+
+private:
+	sf::Vector2f world_size_;
+	float radius_;
+	float sub_dt_ = 1.f / 60.f; // the sub-step that position - previous is the displacement over
+
+	SpatialGrid<CellsX, CellsY> grid_;
+	ThreadPool workers_;
+
+public:
+	ParticleSolver(const sf::Vector2f world_size, const float radius, const unsigned thread_count = std::thread::hardware_concurrency())
+		: world_size_(world_size), radius_(radius), grid_({ 0.f, 0.f, world_size.x, world_size.y }, 0.f), workers_(thread_count)
+	{
+		if (grid_.m_cellSize.x < radius * 2.f || grid_.m_cellSize.y < radius * 2.f)
+			std::cerr << "[ERROR]: ParticleSolver cells are smaller than a particle, collisions will be missed" << '\n';
+	}
+
+
+	// velocity in world units per second
+	size_t add_particle(const sf::Vector2f position, const sf::Vector2f velocity = {})
+	{
+		position_x.push_back(position.x);
+		position_y.push_back(position.y);
+		previous_x.push_back(position.x - velocity.x * sub_dt_);
+		previous_y.push_back(position.y - velocity.y * sub_dt_);
+		return position_x.size() - 1;
+	}
+
+	[[nodiscard]] sf::Vector2f velocity(const size_t index) const
+	{
+		return { (position_x[index] - previous_x[index]) / sub_dt_, (position_y[index] - previous_y[index]) / sub_dt_ };
+	}
+
+	void reserve(const size_t count)
+	{
+		position_x.reserve(count);
+		position_y.reserve(count);
+		previous_x.reserve(count);
+		previous_y.reserve(count);
+	}
+
+	[[nodiscard]] size_t size() const { return position_x.size(); }
+	[[nodiscard]] float radius() const { return radius_; }
+	[[nodiscard]] const SpatialGrid<CellsX, CellsY>& grid() const { return grid_; }
+
+
+	void step(const float dt, const unsigned substeps = 1)
+	{
+		const float sub_dt = dt / static_cast<float>(substeps == 0 ? 1 : substeps);
+		set_sub_step(sub_dt);
+
+		for (unsigned i = 0; i < substeps; ++i)
+		{
+			integrate(sub_dt);
+			apply_bounds();
+			rebuild_grid();
+			solve_collisions();
+			apply_bounds();
+		}
+	}
+
+private:
+	// rescales the stored displacements so the velocities are kept across a change of sub-step
+	void set_sub_step(const float sub_dt)
+	{
+		if (sub_dt == sub_dt_)
+			return;
+
+		const float scale = sub_dt / sub_dt_;
+		sub_dt_ = sub_dt;
+
+		workers_.parallel_for(size(), [&](const size_t begin, const size_t end)
+		{
+			for (size_t i = begin; i < end; ++i)
+			{
+				previous_x[i] = position_x[i] - (position_x[i] - previous_x[i]) * scale;
+				previous_y[i] = position_y[i] - (position_y[i] - previous_y[i]) * scale;
+			}
+		});
+	}
+
+
+	void integrate(const float dt)
+	{
+		const float ax = gravity.x * dt * dt;
+		const float ay = gravity.y * dt * dt;
+
+		workers_.parallel_for(size(), [&](const size_t begin, const size_t end)
+		{
+			for (size_t i = begin; i < end; ++i)
+			{
+				const float vx = position_x[i] - previous_x[i];
+				const float vy = position_y[i] - previous_y[i];
+				previous_x[i] = position_x[i];
+				previous_y[i] = position_y[i];
+				position_x[i] += vx + ax;
+				position_y[i] += vy + ay;
+			}
+		});
+	}
+
+
+	void apply_bounds()
+	{
+		workers_.parallel_for(size(), [&](const size_t begin, const size_t end)
+		{
+			for (size_t i = begin; i < end; ++i)
+			{
+				if (toroidal)
+				{
+					wrap_axis(position_x[i], previous_x[i], world_size_.x);
+					wrap_axis(position_y[i], previous_y[i], world_size_.y);
+				}
+				else
+				{
+					bounce_axis(position_x[i], previous_x[i], world_size_.x);
+					bounce_axis(position_y[i], previous_y[i], world_size_.y);
+				}
+			}
+		});
+	}
+
+	// the previous position moves with the particle so its velocity is kept
+	static void wrap_axis(float& position, float& previous, const float size)
+	{
+		if (position < 0.f)
+		{
+			position += size;
+			previous += size;
+		}
+		else if (position >= size)
+		{
+			position -= size;
+			previous -= size;
+		}
+	}
+
+	void bounce_axis(float& position, float& previous, const float size) const
+	{
+		if (position < radius_)
+		{
+			const float velocity = position - previous;
+			position = radius_;
+			previous = position + velocity * wall_restitution;
+		}
+		else if (position > size - radius_)
+		{
+			const float velocity = position - previous;
+			position = size - radius_;
+			previous = position + velocity * wall_restitution;
+		}
+	}
+
+
+	void rebuild_grid()
+	{
+		grid_.clear();
+		for (size_t i = 0; i < size(); ++i)
+		{
+			grid_.add_object(position_x[i], position_y[i], i);
+		}
+	}
+
+
+	void solve_collisions()
+	{
+		const bool parallel = !toroidal || (CellsX % 3 == 0 && CellsY % 2 == 0);
+
+		for (size_t colour_y = 0; colour_y < 2; ++colour_y)
+		{
+			for (size_t colour_x = 0; colour_x < 3; ++colour_x)
+			{
+				const size_t rows = (CellsY - colour_y + 1) / 2;
+				const auto solve_rows = [&](const size_t begin, const size_t end)
+				{
+					for (size_t row = begin; row < end; ++row)
+					{
+						for (size_t x = colour_x; x < CellsX; x += 3)
+							solve_cell(x, colour_y + row * 2);
+					}
+				};
+
+				if (parallel)
+					workers_.parallel_for(rows, solve_rows);
+				else
+					solve_rows(0, rows);
+			}
+		}
+	}
+
+	// the cell against itself, then against the right, lower left, lower and lower right neighbours
+	void solve_cell(const size_t x, const size_t y)
+	{
+		const cell_idx cell = static_cast<cell_idx>(y * CellsX + x);
+		const uint8_t count = grid_.objects_count[cell];
+		if (count == 0)
+			return;
+
+		const auto& ids = grid_.grid[cell];
+		for (uint8_t i = 0; i < count; ++i)
+		{
+			for (uint8_t j = i + 1; j < count; ++j)
+				collide(ids[i], ids[j]);
+		}
+
+		constexpr int offsets[4][2] = { { 1, 0 }, { -1, 1 }, { 0, 1 }, { 1, 1 } };
+		for (const auto& offset : offsets)
+		{
+			auto neighbour_x = static_cast<int64_t>(x) + offset[0];
+			auto neighbour_y = static_cast<int64_t>(y) + offset[1];
+
+			if (toroidal)
+			{
+				neighbour_x = (neighbour_x + static_cast<int64_t>(CellsX)) % static_cast<int64_t>(CellsX);
+				neighbour_y %= static_cast<int64_t>(CellsY);
+			}
+			else if (neighbour_x < 0 || neighbour_x >= static_cast<int64_t>(CellsX) || neighbour_y >= static_cast<int64_t>(CellsY))
+			{
+				continue;
+			}
+
+			const cell_idx other = static_cast<cell_idx>(neighbour_y * static_cast<int64_t>(CellsX) + neighbour_x);
+			const auto& other_ids = grid_.grid[other];
+			for (uint8_t i = 0; i < count; ++i)
+			{
+				for (uint8_t j = 0; j < grid_.objects_count[other]; ++j)
+					collide(ids[i], other_ids[j]);
+			}
+		}
+	}
+
+	void collide(const obj_idx a, const obj_idx b)
+	{
+		float dx = position_x[a] - position_x[b];
+		float dy = position_y[a] - position_y[b];
+
+		if (toroidal)
+		{
+			// shortest way around the world
+			if (dx > world_size_.x * 0.5f) dx -= world_size_.x;
+			else if (dx < -world_size_.x * 0.5f) dx += world_size_.x;
+			if (dy > world_size_.y * 0.5f) dy -= world_size_.y;
+			else if (dy < -world_size_.y * 0.5f) dy += world_size_.y;
+		}
+
+		const float min_distance = radius_ * 2.f;
+		const float distance_sq = dx * dx + dy * dy;
+		if (distance_sq >= min_distance * min_distance || distance_sq <= 1e-12f)
+			return;
+
+		const float distance = std::sqrt(distance_sq);
+		const float nx = dx / distance;
+		const float ny = dy / distance;
+
+		// separate them, moving the previous positions too so the push doesn't turn into velocity
+		const float push = (min_distance - distance) * 0.5f;
+		position_x[a] += nx * push; previous_x[a] += nx * push;
+		position_y[a] += ny * push; previous_y[a] += ny * push;
+		position_x[b] -= nx * push; previous_x[b] -= nx * push;
+		position_y[b] -= ny * push; previous_y[b] -= ny * push;
+
+		// equal masses: exchange the velocity along the normal if they are approaching (accurate_ball_collision)
+		const float relative_normal_velocity =
+			(position_x[a] - previous_x[a] - position_x[b] + previous_x[b]) * nx +
+			(position_y[a] - previous_y[a] - position_y[b] + previous_y[b]) * ny;
+
+		if (relative_normal_velocity >= 0.f)
+			return;
+
+		const float impulse = -(1.f + restitution) * relative_normal_velocity * 0.5f;
+		previous_x[a] -= nx * impulse;
+		previous_y[a] -= ny * impulse;
+		previous_x[b] += nx * impulse;
+		previous_y[b] += ny * impulse;
+	}
+};
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+/*
+	PrimitiveBatch
+- a retained replacement for draw_rect_outline / make_line / create_triangle when drawing many primitives
+- primitives are appended into one vertex vector per (primitive type, render states) group
+- flush() issues one draw call per group and clears the vertices while keeping their capacity,
+  so in steady state a frame of debug overlay costs no allocations and a handful of draw calls
+- a group left empty for a whole frame is dropped on the next clear() and its vertex memory is pooled for the next new group,
+  so states that change every frame (a camera transform) don't pile up groups
+
+	batch.add_line(a, b, sf::Color::Red);
+	batch.add_rect_outline(bounds);
+	batch.flush(window);
+*/
+
+class PrimitiveBatch
+{
+	struct Group
+	{
+		sf::PrimitiveType type;
+		sf::RenderStates states;
+		std::vector<sf::Vertex> vertices;
+	};
+
+	std::vector<Group> groups_;
+	std::vector<std::vector<sf::Vertex>> free_vertices_; // memory of dropped groups
+	size_t last_group_ = 0;
+
+public:
+	void add_line(const sf::Vector2f& start_position, const sf::Vector2f& end_position,
+		const sf::Color color = sf::Color::White, const sf::RenderStates& render_states = sf::RenderStates())
+	{
+		sf::Vertex* vertices = allocate(sf::Lines, 2, render_states);
+		vertices[0] = { start_position, color };
+		vertices[1] = { end_position, color };
+	}
+
+
+	void add_rect_outline(const sf::Vector2f top_left, const sf::Vector2f bottom_right,
+		const sf::Color color = sf::Color::White, const sf::RenderStates& render_states = sf::RenderStates())
+	{
+		const sf::Vector2f top_right = { bottom_right.x, top_left.y };
+		const sf::Vector2f bottom_left = { top_left.x, bottom_right.y };
+
+		sf::Vertex* vertices = allocate(sf::Lines, 8, render_states);
+		vertices[0] = { top_left, color };
+		vertices[1] = { top_right, color };
+		vertices[2] = { top_right, color };
+		vertices[3] = { bottom_right, color };
+		vertices[4] = { bottom_right, color };
+		vertices[5] = { bottom_left, color };
+		vertices[6] = { bottom_left, color };
+		vertices[7] = { top_left, color };
+	}
+
+	void add_rect_outline(const sf::Rect<float>& rect, const sf::Color color = sf::Color::White,
+		const sf::RenderStates& render_states = sf::RenderStates())
+	{
+		add_rect_outline({ rect.left, rect.top }, { rect.left + rect.width, rect.top + rect.height }, color, render_states);
+	}
+
+
+	void add_triangle(const sf::Vector2f& p1, const sf::Vector2f& p2, const sf::Vector2f& p3,
+		const sf::Color color = sf::Color::White, const sf::RenderStates& render_states = sf::RenderStates())
+	{
+		sf::Vertex* vertices = allocate(sf::Triangles, 3, render_states);
+		vertices[0] = { p1, color };
+		vertices[1] = { p2, color };
+		vertices[2] = { p3, color };
+	}
+
+	// same shape as create_triangle: the tip points up (-y) before being rotated by orientation around the center
+	void add_triangle(const float center_x, const float center_y, const float orientation, const float width,
+		const float height, const sf::Color color = sf::Color::White, const sf::RenderStates& render_states = sf::RenderStates())
+	{
+		const float cos_theta = std::cos(orientation);
+		const float sin_theta = std::sin(orientation);
+
+		const auto rotate = [&](const float x, const float y) -> sf::Vector2f
+		{
+			return { cos_theta * x - sin_theta * y + center_x, sin_theta * x + cos_theta * y + center_y };
+		};
+
+		add_triangle(rotate(-width / 2, height / 2), rotate(width / 2, height / 2), rotate(0.f, -height / 2), color, render_states);
+	}
+
+
+	// reserves count vertices at the end of the matching group for the caller to fill in
+	// the pointer is only valid until the next call that adds to the batch
+	sf::Vertex* allocate(const sf::PrimitiveType type, const size_t count, const sf::RenderStates& render_states = sf::RenderStates())
+	{
+		std::vector<sf::Vertex>& vertices = find_group(type, render_states).vertices;
+		const size_t offset = vertices.size();
+		vertices.resize(offset + count);
+		return vertices.data() + offset;
+	}
+
+
+	// one draw call per non-empty group, in the order the groups were first used
+	void draw(sf::RenderTarget& target) const
+	{
+		for (const Group& group : groups_)
+		{
+			if (!group.vertices.empty())
+				target.draw(group.vertices.data(), group.vertices.size(), group.type, group.states);
+		}
+	}
+
+	// empties every group but keeps the allocated memory for the next frame, groups that were already empty are dropped
+	void clear()
+	{
+		size_t kept = 0;
+		for (Group& group : groups_)
+		{
+			if (group.vertices.empty())
+			{
+				free_vertices_.push_back(std::move(group.vertices));
+				continue;
+			}
+
+			group.vertices.clear();
+			if (&groups_[kept] != &group)
+				groups_[kept] = std::move(group);
+			++kept;
+		}
+
+		groups_.erase(groups_.begin() + static_cast<std::ptrdiff_t>(kept), groups_.end());
+		last_group_ = 0;
+	}
+
+	void flush(sf::RenderTarget& target)
+	{
+		draw(target);
+		clear();
+	}
+
+	[[nodiscard]] size_t group_count() const { return groups_.size(); }
+
+	[[nodiscard]] size_t vertex_count() const
+	{
+		size_t total = 0;
+		for (const Group& group : groups_)
+			total += group.vertices.size();
+		return total;
+	}
+
+private:
+	Group& find_group(const sf::PrimitiveType type, const sf::RenderStates& render_states)
+	{
+		// consecutive primitives almost always share their states, so check the previous group first
+		if (last_group_ < groups_.size() && matches(groups_[last_group_], type, render_states))
+			return groups_[last_group_];
+
+		for (size_t i = 0; i < groups_.size(); ++i)
+		{
+			if (matches(groups_[i], type, render_states))
+			{
+				last_group_ = i;
+				return groups_[i];
+			}
+		}
+
+		last_group_ = groups_.size();
+		groups_.push_back({ type, render_states, {} });
+
+		if (!free_vertices_.empty())
+		{
+			groups_.back().vertices = std::move(free_vertices_.back());
+			free_vertices_.pop_back();
+		}
+		return groups_.back();
+	}
+
+	static bool matches(const Group& group, const sf::PrimitiveType type, const sf::RenderStates& render_states)
+	{
+		const float* a = group.states.transform.getMatrix();
+		const float* b = render_states.transform.getMatrix();
+
+		return group.type == type
+			&& group.states.texture == render_states.texture
+			&& group.states.shader == render_states.shader
+			&& group.states.blendMode == render_states.blendMode
+			&& std::equal(a, a + 16, b);
+	}
+};
@@ -0,0 +1,361 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "stop_watch.h"
+
+/*
+	Profiler
+- hierarchical scoped zones: PROFILE_SCOPE("grid build") times the enclosing block, PROFILE_FUNCTION() the enclosing function
+- each thread writes its zones into its own lock-free ring buffer, nothing is shared on the hot path
+- timestamps come from the TSC where available and are converted to time with a StopWatch calibration
+- PROFILE_END_FRAME() drains every thread and aggregates count / total / self time per zone for that frame
+- write_chrome_trace() dumps the recorded zones as JSON for chrome://tracing or https://ui.perfetto.dev
+- define ENABLE_PROFILER before including this header, otherwise every macro compiles to nothing,
+  except that PROFILE_END_FRAME() then returns an empty list and PROFILE_WRITE_TRACE() returns false
+- zone names must outlive the profiler, string literals and __func__ are fine
+*/
+
+namespace Profiler
+{
+	// maximum nesting depth tracked for self time, deeper zones are still recorded
+	static constexpr uint32_t max_depth = 64;
+
+	// events per thread that may be buffered between two end_frame() calls, anything beyond is dropped
+	static constexpr size_t ring_capacity = 1 << 14;
+
+
+	inline uint64_t read_ticks()
+	{
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+		return __rdtsc();
+#else
+		return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+	}
+
+
+	// measures how many ticks pass per second by busy waiting on a StopWatch
+	inline double calibrate_ticks_per_second(const double duration_seconds = 0.05)
+	{
+		StopWatch watch;
+		const uint64_t start_ticks = read_ticks();
+
+		double elapsed = 0.0;
+		while (elapsed < duration_seconds)
+		{
+			elapsed += watch.get_delta();
+		}
+
+		return static_cast<double>(read_ticks() - start_ticks) / elapsed;
+	}
+
+	inline double ticks_per_second()
+	{
+		static const double calibrated = calibrate_ticks_per_second();
+		return calibrated;
+	}
+
+	inline double ticks_to_ms(const uint64_t ticks)
+	{
+		return static_cast<double>(ticks) * 1000.0 / ticks_per_second();
+	}
+
+
+	struct ZoneEvent
+	{
+		const char* name = nullptr;
+		uint64_t start = 0;
+		uint64_t end = 0;
+		uint64_t self = 0;
+		uint32_t depth = 0;
+	};
+
+
+	// single producer (the owning thread) / single consumer (whoever calls end_frame) queue
+	template<size_t Capacity>
+	class EventRing
+	{
+		static_assert((Capacity & (Capacity - 1)) == 0, "EventRing capacity must be a power of two");
+
+		std::array<ZoneEvent, Capacity> events_{};
+		alignas(64) std::atomic<size_t> head_{ 0 }; // written by the producer
+		alignas(64) std::atomic<size_t> tail_{ 0 }; // written by the consumer
+
+	public:
+		bool push(const ZoneEvent& event)
+		{
+			const size_t head = head_.load(std::memory_order_relaxed);
+			if (head - tail_.load(std::memory_order_acquire) >= Capacity)
+				return false;
+
+			events_[head & (Capacity - 1)] = event;
+			head_.store(head + 1, std::memory_order_release);
+			return true;
+		}
+
+		template<typename Func>
+		void drain(Func&& func)
+		{
+			const size_t head = head_.load(std::memory_order_acquire);
+			size_t tail = tail_.load(std::memory_order_relaxed);
+
+			for (; tail != head; ++tail)
+			{
+				func(events_[tail & (Capacity - 1)]);
+			}
+
+			tail_.store(tail, std::memory_order_release);
+		}
+	};
+
+
+	struct ThreadLog
+	{
+		EventRing<ring_capacity> ring;
+		std::atomic<uint64_t> dropped{ 0 };
+		uint32_t thread_id = 0;
+
+		// only touched by the owning thread
+		uint32_t depth = 0;
+		std::array<uint64_t, max_depth> child_ticks{};
+	};
+
+
+	struct ZoneStats
+	{
+		const char* name = nullptr;
+		uint32_t count = 0;
+		double total_ms = 0.0;
+		double self_ms = 0.0;
+	};
+
+
+	class Collector
+	{
+		struct TraceEvent
+		{
+			ZoneEvent zone;
+			uint32_t thread_id;
+		};
+
+		std::mutex mutex_;
+		std::vector<std::unique_ptr<ThreadLog>> logs_;
+
+		std::vector<ZoneStats> frame_stats_;
+		std::unordered_map<std::string_view, size_t> stats_index_;
+
+		bool record_trace_ = false;
+		std::vector<TraceEvent> trace_;
+		uint64_t trace_origin_ = 0;
+
+	public:
+		// logs live until the program ends so zones from finished threads can still be collected
+		ThreadLog* register_thread()
+		{
+			std::lock_guard lock(mutex_);
+			logs_.push_back(std::make_unique<ThreadLog>());
+			logs_.back()->thread_id = static_cast<uint32_t>(logs_.size() - 1);
+			return logs_.back().get();
+		}
+
+		// keeps every collected zone for write_chrome_trace(), memory grows with the recording length
+		void set_trace_recording(const bool record)
+		{
+			std::lock_guard lock(mutex_);
+			record_trace_ = record;
+			if (record && trace_origin_ == 0)
+				trace_origin_ = read_ticks();
+		}
+
+		// drains every thread and returns the per-zone statistics of everything recorded since the last call
+		const std::vector<ZoneStats>& end_frame()
+		{
+			std::lock_guard lock(mutex_);
+
+			for (ZoneStats& stats : frame_stats_)
+			{
+				stats.count = 0;
+				stats.total_ms = 0.0;
+				stats.self_ms = 0.0;
+			}
+
+			for (const auto& log : logs_)
+			{
+				log->ring.drain([&](const ZoneEvent& event)
+				{
+					ZoneStats& stats = stats_for(event.name);
+					++stats.count;
+					stats.total_ms += ticks_to_ms(event.end - event.start);
+					stats.self_ms += ticks_to_ms(event.self);
+
+					if (record_trace_)
+						trace_.push_back({ event, log->thread_id });
+				});
+			}
+
+			return frame_stats_;
+		}
+
+		[[nodiscard]] uint64_t dropped_events()
+		{
+			std::lock_guard lock(mutex_);
+			uint64_t total = 0;
+			for (const auto& log : logs_)
+				total += log->dropped.load(std::memory_order_relaxed);
+			return total;
+		}
+
+		// writes the recorded zones in the chrome trace event format
+		bool write_chrome_trace(const std::string& filename)
+		{
+			std::lock_guard lock(mutex_);
+
+			std::ofstream file(filename);
+			if (!file)
+			{
+				return false;
+			}
+
+			// microseconds with 3 decimals keep nanosecond resolution however long the recording ran
+			file << std::fixed << std::setprecision(3);
+			file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+			bool first = true;
+			for (const TraceEvent& event : trace_)
+			{
+				// clip events which started before recording was switched on
+				const uint64_t start = event.zone.start > trace_origin_ ? event.zone.start - trace_origin_ : 0;
+
+				file << (first ? "" : ",") << "\n{\"name\":\"";
+				write_escaped(file, event.zone.name);
+				file << "\",\"cat\":\"zone\",\"ph\":\"X\",\"pid\":0"
+					<< ",\"tid\":" << event.thread_id
+					<< ",\"ts\":" << ticks_to_ms(start) * 1000.0
+					<< ",\"dur\":" << ticks_to_ms(event.zone.end - event.zone.start) * 1000.0 << "}";
+				first = false;
+			}
+
+			file << "\n]}\n";
+			return static_cast<bool>(file);
+		}
+
+		void clear_trace()
+		{
+			std::lock_guard lock(mutex_);
+			trace_.clear();
+			trace_origin_ = read_ticks();
+		}
+
+	private:
+		ZoneStats& stats_for(const char* name)
+		{
+			const auto [it, inserted] = stats_index_.try_emplace(name, frame_stats_.size());
+			if (inserted)
+				frame_stats_.push_back({ name });
+			return frame_stats_[it->second];
+		}
+
+		static void write_escaped(std::ofstream& file, const char* text)
+		{
+			for (; *text != '\0'; ++text)
+			{
+				if (*text == '"' || *text == '\\')
+					file << '\\';
+				file << *text;
+			}
+		}
+	};
+
+
+	inline Collector& collector()
+	{
+		static Collector instance;
+		return instance;
+	}
+
+	// what PROFILE_END_FRAME() returns when the profiler is disabled
+	inline const std::vector<ZoneStats>& no_zones()
+	{
+		static const std::vector<ZoneStats> empty;
+		return empty;
+	}
+
+	inline ThreadLog& thread_log()
+	{
+		thread_local ThreadLog* log = collector().register_thread();
+		return *log;
+	}
+
+
+	class ScopedZone
+	{
+		ThreadLog& log_;
+		const char* name_;
+		uint32_t depth_;
+		uint64_t start_;
+
+	public:
+		explicit ScopedZone(const char* name) : log_(thread_log()), name_(name), depth_(log_.depth++)
+		{
+			if (depth_ < max_depth)
+				log_.child_ticks[depth_] = 0;
+
+			start_ = read_ticks();
+		}
+
+		~ScopedZone()
+		{
+			const uint64_t end = read_ticks();
+			const uint64_t duration = end - start_;
+			--log_.depth;
+
+			// children add their duration to the slot of their parent, whatever remains is this zone's self time
+			const uint64_t children = depth_ < max_depth ? log_.child_ticks[depth_] : 0;
+			if (depth_ > 0 && depth_ - 1 < max_depth)
+				log_.child_ticks[depth_ - 1] += duration;
+
+			const ZoneEvent event{ name_, start_, end, duration > children ? duration - children : 0, depth_ };
+			if (!log_.ring.push(event))
+				log_.dropped.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		ScopedZone(const ScopedZone&) = delete;
+		ScopedZone& operator=(const ScopedZone&) = delete;
+	};
+}
+
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifdef ENABLE_PROFILER
+#define PROFILE_SCOPE(name) const Profiler::ScopedZone PROFILE_CONCAT(profile_zone_, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__func__)
+#define PROFILE_END_FRAME() Profiler::collector().end_frame()
+#define PROFILE_RECORD_TRACE(record) Profiler::collector().set_trace_recording(record)
+#define PROFILE_WRITE_TRACE(filename) Profiler::collector().write_chrome_trace(filename)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_FUNCTION() ((void)0)
+#define PROFILE_END_FRAME() Profiler::no_zones()
+#define PROFILE_RECORD_TRACE(record) ((void)0)
+#define PROFILE_WRITE_TRACE(filename) ((void)(filename), false)
+#endif
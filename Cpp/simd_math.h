@@ -0,0 +1,438 @@
+#pragma once
+
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#if defined(__AVX2__)
+#define SIMD_MATH_AVX2 1
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMD_MATH_SSE2 1
+#endif
+
+#if defined(SIMD_MATH_AVX2) || defined(SIMD_MATH_SSE2)
+#include <immintrin.h>
+#endif
+
+/*
+	simd_math
+- batch kernels over plain float arrays (structure of arrays), for running the same maths over every entity at once
+- the widest instruction set enabled at compile time is used (AVX2 -> SSE2 -> scalar), the remainder is always done scalar
+- build with -mavx2 -mfma (gcc / clang) or /arch:AVX2 (msvc) to get the AVX2 path
+- the kernels are written once against a small lane interface (ScalarLanes / SseLanes / AvxLanes)
+
+	vector kernels
+- dot_batch, length_batch, dist_squared_batch, normalize_batch, clamp_length_batch work on 2d vectors split into x and y arrays
+- rsqrt_batch is the hardware estimate refined by one Newton step (relative error ~1e-6), the scalar fallback is exact
+  and so are 0, inf and denormal inputs in every lane (0 gives inf, as 1 / std::sqrt does)
+- wrap_angles_batch maps angles into [0, 2pi) in constant time, like normalize_angle()
+
+	sincos_batch
+- fast sin and cos of an array of angles, the errors below hold for |angle| <= 1e5 radians
+- larger angles lose precision in the range reduction (~1e-1 by 1e6 radians without FMA) and past ~1e7 the results
+  are meaningless, they may leave [-1, 1]. no input is undefined behaviour: the quadrant is clamped before its
+  conversion to int, inf and nan give non-finite results
+- TrigAccuracy::Fast max error ~2e-4, Balanced ~1e-6, Precise ~1e-7 (float precision)
+*/
+
+enum class TrigAccuracy { Fast, Balanced, Precise };
+
+namespace simd
+{
+	struct ScalarLanes
+	{
+		using Float = float;
+		using Int = int32_t;
+		static constexpr size_t width = 1;
+
+		static Float load(const float* p) { return *p; }
+		static void store(float* p, const Float v) { *p = v; }
+
+		// writes lane k's (x, y) pair to p + k * stride, e.g. into the positions of an array of structs
+		static void store_pairs(float* p, size_t, const Float x, const Float y)
+		{
+			p[0] = x;
+			p[1] = y;
+		}
+		static Float set(const float v) { return v; }
+		static Int set_int(const int32_t v) { return v; }
+
+		static Float add(const Float a, const Float b) { return a + b; }
+		static Float sub(const Float a, const Float b) { return a - b; }
+		static Float mul(const Float a, const Float b) { return a * b; }
+		static Float mul_add(const Float a, const Float b, const Float c) { return a * b + c; }
+		static Float div(const Float a, const Float b) { return a / b; }
+		static Float sqrt(const Float v) { return std::sqrt(v); }
+		static Float rsqrt(const Float v) { return 1.f / std::sqrt(v); }
+		static Float min(const Float a, const Float b) { return a < b ? a : b; }
+		static Float max(const Float a, const Float b) { return a > b ? a : b; }
+		static Float floor(const Float v) { return std::floor(v); }
+
+		// picks a where the mask is set, b otherwise
+		using Mask = bool;
+		static Mask less(const Float a, const Float b) { return a < b; }
+		static Float blend(const Mask mask, const Float a, const Float b) { return mask ? a : b; }
+
+		static Int round_to_int(const Float v) { return static_cast<Int>(std::nearbyint(v)); }
+		static Float to_float(const Int v) { return static_cast<Float>(v); }
+		static Int and_int(const Int a, const Int b) { return a & b; }
+		static Int add_int(const Int a, const Int b) { return a + b; }
+
+		// flips the sign of v where bit 31 of sign_bits is set
+		static Float flip_sign(const Float v, const Int sign_bits)
+		{
+			return std::bit_cast<float>(std::bit_cast<uint32_t>(v) ^ (static_cast<uint32_t>(sign_bits) << 30 & 0x80000000u));
+		}
+
+		// picks a where the integer condition is non zero, b otherwise
+		static Float select(const Int condition, const Float a, const Float b) { return condition != 0 ? a : b; }
+	};
+
+
+#if defined(SIMD_MATH_SSE2)
+	struct SseLanes
+	{
+		using Float = __m128;
+		using Int = __m128i;
+		static constexpr size_t width = 4;
+
+		static Float load(const float* p) { return _mm_loadu_ps(p); }
+		static void store(float* p, const Float v) { _mm_storeu_ps(p, v); }
+
+		static void store_pairs(float* p, const size_t stride, const Float x, const Float y)
+		{
+			const Float low = _mm_unpacklo_ps(x, y);
+			const Float high = _mm_unpackhi_ps(x, y);
+			_mm_storel_pi(reinterpret_cast<__m64*>(p), low);
+			_mm_storeh_pi(reinterpret_cast<__m64*>(p + stride), low);
+			_mm_storel_pi(reinterpret_cast<__m64*>(p + stride * 2), high);
+			_mm_storeh_pi(reinterpret_cast<__m64*>(p + stride * 3), high);
+		}
+		static Float set(const float v) { return _mm_set1_ps(v); }
+		static Int set_int(const int32_t v) { return _mm_set1_epi32(v); }
+
+		static Float add(const Float a, const Float b) { return _mm_add_ps(a, b); }
+		static Float sub(const Float a, const Float b) { return _mm_sub_ps(a, b); }
+		static Float mul(const Float a, const Float b) { return _mm_mul_ps(a, b); }
+		static Float mul_add(const Float a, const Float b, const Float c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+		static Float div(const Float a, const Float b) { return _mm_div_ps(a, b); }
+		static Float sqrt(const Float v) { return _mm_sqrt_ps(v); }
+		static Float min(const Float a, const Float b) { return _mm_min_ps(a, b); }
+		static Float max(const Float a, const Float b) { return _mm_max_ps(a, b); }
+
+		// estimate refined by one Newton-Raphson step. for 0, inf, denormals and negatives the step gives NaN or -inf
+		// (0 * inf and friends), those lanes take the exact 1 / sqrt like ScalarLanes does
+		static Float rsqrt(const Float v)
+		{
+			const Float estimate = _mm_rsqrt_ps(v);
+			const Float half_v_y2 = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), v), _mm_mul_ps(estimate, estimate));
+			const Float refined = _mm_mul_ps(estimate, _mm_sub_ps(_mm_set1_ps(1.5f), half_v_y2));
+
+			const Float magnitude = _mm_andnot_ps(_mm_set1_ps(-0.f), refined);
+			const Float finite = _mm_cmplt_ps(magnitude, _mm_set1_ps(std::numeric_limits<float>::infinity()));
+			if (_mm_movemask_ps(finite) == 0xF)
+				return refined;
+
+			const Float exact = _mm_div_ps(_mm_set1_ps(1.f), _mm_sqrt_ps(v));
+			return _mm_or_ps(_mm_and_ps(finite, refined), _mm_andnot_ps(finite, exact));
+		}
+
+		// SSE2 has no floor, truncate and step down where that rounded up (valid for |v| < 2^31)
+		static Float floor(const Float v)
+		{
+			const Float truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(v));
+			return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, v), _mm_set1_ps(1.f)));
+		}
+
+		using Mask = __m128;
+		static Mask less(const Float a, const Float b) { return _mm_cmplt_ps(a, b); }
+		static Float blend(const Mask mask, const Float a, const Float b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+
+		static Int round_to_int(const Float v) { return _mm_cvtps_epi32(v); }
+		static Float to_float(const Int v) { return _mm_cvtepi32_ps(v); }
+		static Int and_int(const Int a, const Int b) { return _mm_and_si128(a, b); }
+		static Int add_int(const Int a, const Int b) { return _mm_add_epi32(a, b); }
+
+		static Float flip_sign(const Float v, const Int sign_bits)
+		{
+			const Int sign = _mm_and_si128(_mm_slli_epi32(sign_bits, 30), _mm_set1_epi32(static_cast<int32_t>(0x80000000u)));
+			return _mm_xor_ps(v, _mm_castsi128_ps(sign));
+		}
+
+		static Float select(const Int condition, const Float a, const Float b)
+		{
+			const Float mask = _mm_castsi128_ps(_mm_cmpeq_epi32(condition, _mm_setzero_si128()));
+			return _mm_or_ps(_mm_andnot_ps(mask, a), _mm_and_ps(mask, b));
+		}
+	};
+#endif
+
+
+#if defined(SIMD_MATH_AVX2)
+	struct AvxLanes
+	{
+		using Float = __m256;
+		using Int = __m256i;
+		static constexpr size_t width = 8;
+
+		static Float load(const float* p) { return _mm256_loadu_ps(p); }
+		static void store(float* p, const Float v) { _mm256_storeu_ps(p, v); }
+
+		// unpack interleaves within each 128 bit half: low = x0 y0 x1 y1 | x4 y4 x5 y5, high = x2 y2 x3 y3 | x6 y6 x7 y7
+		static void store_pairs(float* p, const size_t stride, const Float x, const Float y)
+		{
+			const Float low = _mm256_unpacklo_ps(x, y);
+			const Float high = _mm256_unpackhi_ps(x, y);
+			const __m128 pairs[4] = { _mm256_castps256_ps128(low), _mm256_castps256_ps128(high),
+									  _mm256_extractf128_ps(low, 1), _mm256_extractf128_ps(high, 1) };
+			for (size_t half = 0; half < 4; ++half)
+			{
+				_mm_storel_pi(reinterpret_cast<__m64*>(p + stride * half * 2), pairs[half]);
+				_mm_storeh_pi(reinterpret_cast<__m64*>(p + stride * (half * 2 + 1)), pairs[half]);
+			}
+		}
+		static Float set(const float v) { return _mm256_set1_ps(v); }
+		static Int set_int(const int32_t v) { return _mm256_set1_epi32(v); }
+
+		static Float add(const Float a, const Float b) { return _mm256_add_ps(a, b); }
+		static Float sub(const Float a, const Float b) { return _mm256_sub_ps(a, b); }
+		static Float mul(const Float a, const Float b) { return _mm256_mul_ps(a, b); }
+#if defined(__FMA__)
+		static Float mul_add(const Float a, const Float b, const Float c) { return _mm256_fmadd_ps(a, b, c); }
+#else
+		static Float mul_add(const Float a, const Float b, const Float c) { return _mm256_add_ps(_mm256_mul_ps(a, b), c); }
+#endif
+
+		static Float div(const Float a, const Float b) { return _mm256_div_ps(a, b); }
+		static Float sqrt(const Float v) { return _mm256_sqrt_ps(v); }
+		static Float min(const Float a, const Float b) { return _mm256_min_ps(a, b); }
+		static Float max(const Float a, const Float b) { return _mm256_max_ps(a, b); }
+		static Float floor(const Float v) { return _mm256_floor_ps(v); }
+
+		static Float rsqrt(const Float v)
+		{
+			const Float estimate = _mm256_rsqrt_ps(v);
+			const Float half_v_y2 = _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(0.5f), v), _mm256_mul_ps(estimate, estimate));
+			const Float refined = _mm256_mul_ps(estimate, _mm256_sub_ps(_mm256_set1_ps(1.5f), half_v_y2));
+
+			// same fallback to the exact result as SseLanes::rsqrt
+			const Float magnitude = _mm256_andnot_ps(_mm256_set1_ps(-0.f), refined);
+			const Float finite = _mm256_cmp_ps(magnitude, _mm256_set1_ps(std::numeric_limits<float>::infinity()), _CMP_LT_OQ);
+			if (_mm256_movemask_ps(finite) == 0xFF)
+				return refined;
+
+			const Float exact = _mm256_div_ps(_mm256_set1_ps(1.f), _mm256_sqrt_ps(v));
+			return _mm256_blendv_ps(exact, refined, finite);
+		}
+
+		using Mask = __m256;
+		static Mask less(const Float a, const Float b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+		static Float blend(const Mask mask, const Float a, const Float b) { return _mm256_blendv_ps(b, a, mask); }
+
+		static Int round_to_int(const Float v) { return _mm256_cvtps_epi32(v); }
+		static Float to_float(const Int v) { return _mm256_cvtepi32_ps(v); }
+		static Int and_int(const Int a, const Int b) { return _mm256_and_si256(a, b); }
+		static Int add_int(const Int a, const Int b) { return _mm256_add_epi32(a, b); }
+
+		static Float flip_sign(const Float v, const Int sign_bits)
+		{
+			const Int sign = _mm256_and_si256(_mm256_slli_epi32(sign_bits, 30), _mm256_set1_epi32(static_cast<int32_t>(0x80000000u)));
+			return _mm256_xor_ps(v, _mm256_castsi256_ps(sign));
+		}
+
+		static Float select(const Int condition, const Float a, const Float b)
+		{
+			const Float mask = _mm256_castsi256_ps(_mm256_cmpeq_epi32(condition, _mm256_setzero_si256()));
+			return _mm256_blendv_ps(a, b, mask);
+		}
+	};
+#endif
+
+
+	// runs kernel.template operator()<Lanes>(index) over [0, count) with the widest lanes available, then scalar for the tail
+	template<typename Kernel>
+	void for_each_lane(const size_t count, Kernel&& kernel)
+	{
+		size_t i = 0;
+#if defined(SIMD_MATH_AVX2)
+		for (; i + AvxLanes::width <= count; i += AvxLanes::width)
+			kernel.template operator()<AvxLanes>(i);
+#endif
+#if defined(SIMD_MATH_SSE2)
+		for (; i + SseLanes::width <= count; i += SseLanes::width)
+			kernel.template operator()<SseLanes>(i);
+#endif
+		for (; i < count; ++i)
+			kernel.template operator()<ScalarLanes>(i);
+	}
+
+
+	// sin and cos of x: reduce to r in [-pi/4, pi/4] around the nearest multiple q of pi/2, evaluate
+	// a polynomial for both and then swap / negate them by the quadrant q
+	template<TrigAccuracy Accuracy, typename V>
+	void sincos(const typename V::Float x, typename V::Float& sin_out, typename V::Float& cos_out)
+	{
+		// clamped so the conversion to int32 can't overflow, past 2^30 quarter turns the result is meaningless anyway
+		const typename V::Float turns = V::mul(x, V::set(0.636619772367581343f));
+		const typename V::Int quadrant = V::round_to_int(V::min(V::max(turns, V::set(-1073741824.f)), V::set(1073741824.f)));
+		const typename V::Float q = V::to_float(quadrant);
+
+		// pi/2 split into three parts so q * part is exact (Cody-Waite)
+		typename V::Float r = V::mul_add(q, V::set(-1.5703125f), x);
+		r = V::mul_add(q, V::set(-4.837512969970703125e-4f), r);
+		r = V::mul_add(q, V::set(-7.54978995489188216e-8f), r);
+
+		const typename V::Float r2 = V::mul(r, r);
+		typename V::Float sin_r;
+		typename V::Float cos_r;
+
+		if constexpr (Accuracy == TrigAccuracy::Fast)
+		{
+			sin_r = V::mul(r, V::mul_add(r2, V::set(-0.160344007f), V::set(0.999031418f)));
+			cos_r = V::mul_add(r2, V::mul_add(r2, V::set(0.0403985347f), V::set(-0.499708140f)), V::set(0.999990035f));
+		}
+		else if constexpr (Accuracy == TrigAccuracy::Balanced)
+		{
+			sin_r = V::mul(r, V::mul_add(r2, V::mul_add(r2, V::set(0.00812155779f), V::set(-0.166601620f)), V::set(0.999994998f)));
+			cos_r = V::mul_add(r2, V::mul_add(r2, V::mul_add(r2, V::set(-0.00135859083f), V::set(0.0416550269f)),
+				V::set(-0.499998567f)), V::set(0.999999972f));
+		}
+		else
+		{
+			// cephes sinf / cosf coefficients
+			sin_r = V::mul(r2, V::mul_add(r2, V::mul_add(r2, V::set(-1.9515295891e-4f), V::set(8.3321608736e-3f)),
+				V::set(-1.6666654611e-1f)));
+			sin_r = V::mul_add(sin_r, r, r);
+			cos_r = V::mul_add(r2, V::mul_add(r2, V::mul_add(r2, V::set(2.443315711809948e-5f), V::set(-1.388731625493765e-3f)),
+				V::set(4.166664568298827e-2f)), V::set(-0.5f));
+			cos_r = V::mul_add(cos_r, r2, V::set(1.f));
+		}
+
+		// odd quadrants swap sin and cos, quadrants 2 and 3 negate sin, quadrants 1 and 2 negate cos
+		const typename V::Int odd = V::and_int(quadrant, V::set_int(1));
+		sin_out = V::flip_sign(V::select(odd, cos_r, sin_r), quadrant);
+		cos_out = V::flip_sign(V::select(odd, sin_r, cos_r), V::add_int(quadrant, V::set_int(1)));
+	}
+}
+
+
+template<TrigAccuracy Accuracy = TrigAccuracy::Balanced>
+inline void fast_sincos(const float angle_radians, float& sin_out, float& cos_out)
+{
+	simd::sincos<Accuracy, simd::ScalarLanes>(angle_radians, sin_out, cos_out);
+}
+
+
+// sines[i], cosines[i] = sin(angles[i]), cos(angles[i]) for i in [0, count)
+template<TrigAccuracy Accuracy = TrigAccuracy::Balanced>
+void sincos_batch(const float* angles, float* sines, float* cosines, const size_t count)
+{
+	simd::for_each_lane(count, [&]<typename V>(const size_t i)
+	{
+		typename V::Float s, c;
+		simd::sincos<Accuracy, V>(V::load(angles + i), s, c);
+		V::store(sines + i, s);
+		V::store(cosines + i, c);
+	});
+}
+
+
+// out[i] = a[i] . b[i]
+inline void dot_batch(const float* ax, const float* ay, const float* bx, const float* by, float* out, const size_t count)
+{
+	simd::for_each_lane(count, [&]<typename V>(const size_t i)
+	{
+		V::store(out + i, V::mul_add(V::load(ax + i), V::load(bx + i), V::mul(V::load(ay + i), V::load(by + i))));
+	});
+}
+
+
+// out[i] = |v[i]|
+inline void length_batch(const float* x, const float* y, float* out, const size_t count)
+{
+	simd::for_each_lane(count, [&]<typename V>(const size_t i)
+	{
+		const typename V::Float vx = V::load(x + i);
+		const typename V::Float vy = V::load(y + i);
+		V::store(out + i, V::sqrt(V::mul_add(vx, vx, V::mul(vy, vy))));
+	});
+}
+
+
+// out[i] = |b[i] - a[i]|^2
+inline void dist_squared_batch(const float* ax, const float* ay, const float* bx, const float* by, float* out, const size_t count)
+{
+	simd::for_each_lane(count, [&]<typename V>(const size_t i)
+	{
+		const typename V::Float dx = V::sub(V::load(bx + i), V::load(ax + i));
+		const typename V::Float dy = V::sub(V::load(by + i), V::load(ay + i));
+		V::store(out + i, V::mul_add(dx, dx, V::mul(dy, dy)));
+	});
+}
+
+
+// out[i] = 1 / sqrt(in[i])
+inline void rsqrt_batch(const float* in, float* out, const size_t count)
+{
+	simd::for_each_lane(count, [&]<typename V>(const size_t i)
+	{
+		V::store(out + i, V::rsqrt(V::load(in + i)));
+	});
+}
+
+
+// scales every vector to unit length in place, zero vectors stay zero
+inline void normalize_batch(float* x, float* y, const size_t count)
+{
+	simd::for_each_lane(count, [&]<typename V>(const size_t i)
+	{
+		const typename V::Float vx = V::load(x + i);
+		const typename V::Float vy = V::load(y + i);
+		const typename V::Float length_sq = V::mul_add(vx, vx, V::mul(vy, vy));
+
+		const typename V::Float scale = V::blend(V::less(V::set(0.f), length_sq), V::rsqrt(length_sq), V::set(0.f));
+		V::store(x + i, V::mul(vx, scale));
+		V::store(y + i, V::mul(vy, scale));
+	});
+}
+
+
+// shortens every vector longer than max_length to max_length in place, e.g. clamping velocities to a max speed
+inline void clamp_length_batch(float* x, float* y, const float max_length, const size_t count)
+{
+	simd::for_each_lane(count, [&]<typename V>(const size_t i)
+	{
+		const typename V::Float vx = V::load(x + i);
+		const typename V::Float vy = V::load(y + i);
+		const typename V::Float length_sq = V::mul_add(vx, vx, V::mul(vy, vy));
+		const typename V::Float max_length_v = V::set(max_length);
+
+		const typename V::Float scale = V::blend(V::less(V::mul(max_length_v, max_length_v), length_sq),
+			V::mul(max_length_v, V::rsqrt(length_sq)), V::set(1.f));
+		V::store(x + i, V::mul(vx, scale));
+		V::store(y + i, V::mul(vy, scale));
+	});
+}
+
+
+// maps every angle into [0, 2pi) in place
+inline void wrap_angles_batch(float* angles_radians, const size_t count)
+{
+	constexpr float two_pi = 6.28318530717958647692f;
+
+	simd::for_each_lane(count, [&]<typename V>(const size_t i)
+	{
+		const typename V::Float angle = V::load(angles_radians + i);
+		const typename V::Float turns = V::floor(V::mul(angle, V::set(1.f / two_pi)));
+		typename V::Float wrapped = V::mul_add(turns, V::set(-two_pi), angle);
+
+		// rounding can land a hair outside the range, fold those back in
+		wrapped = V::blend(V::less(wrapped, V::set(0.f)), V::add(wrapped, V::set(two_pi)), wrapped);
+		wrapped = V::blend(V::less(wrapped, V::set(two_pi)), wrapped, V::set(0.f));
+		V::store(angles_radians + i, wrapped);
+	});
+}
@@ -0,0 +1,207 @@
+/*
+	simd_math_test
+- checks every batch kernel of simd_math.h against the same maths done one value at a time in double precision
+- counts are odd so both the widest SIMD path and the scalar tail are covered, build it once per instruction set
+- rsqrt_batch is also checked on 0, inf and denormal inputs, which must match 1 / std::sqrt in every position
+- sincos is checked up to the documented 1e5 radians, huge angles only have to stay non-finite for inf and nan
+
+	c++ -O2 -std=c++20 simd_math_test.cpp -o simd_math_test && ./simd_math_test
+	c++ -O2 -std=c++20 -mavx2 -mfma simd_math_test.cpp -o simd_math_test && ./simd_math_test
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "simd_math.h"
+
+static int failures = 0;
+
+static void check_error(const char* name, const double max_error, const double tolerance)
+{
+	const bool passed = max_error <= tolerance;
+	std::printf("%-24s max error %.3g (tolerance %.3g) %s\n", name, max_error, tolerance, passed ? "ok" : "FAILED");
+	failures += !passed;
+}
+
+static double relative_error(const double value, const double expected)
+{
+	return std::abs(value - expected) / std::max(1.0, std::abs(expected));
+}
+
+// same value, or both NaN
+static bool same_float(const float a, const float b)
+{
+	return (std::isnan(a) && std::isnan(b)) || a == b;
+}
+
+
+template<TrigAccuracy Accuracy>
+static void test_sincos(const char* name, const double tolerance, const float range = 1000.f)
+{
+	constexpr size_t count = 100003;
+	std::vector<float> angles(count), sines(count), cosines(count);
+	for (size_t i = 0; i < count; ++i)
+		angles[i] = -range + 2.f * range * static_cast<float>(i) / count;
+
+	sincos_batch<Accuracy>(angles.data(), sines.data(), cosines.data(), count);
+
+	double max_error = 0.0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		max_error = std::max(max_error, std::abs(sines[i] - std::sin(static_cast<double>(angles[i]))));
+		max_error = std::max(max_error, std::abs(cosines[i] - std::cos(static_cast<double>(angles[i]))));
+	}
+
+	// the scalar entry point shares the polynomial
+	float sine, cosine;
+	fast_sincos<Accuracy>(angles[12345], sine, cosine);
+	max_error = std::max(max_error, std::abs(sine - std::sin(static_cast<double>(angles[12345]))));
+
+	check_error(name, max_error, tolerance);
+}
+
+
+int main()
+{
+	test_sincos<TrigAccuracy::Fast>("sincos fast", 2e-4);
+	test_sincos<TrigAccuracy::Balanced>("sincos balanced", 1e-6);
+	test_sincos<TrigAccuracy::Precise>("sincos precise", 2e-7);
+	test_sincos<TrigAccuracy::Precise>("sincos precise at 1e5", 2e-6, 1e5f);
+
+	// angles far outside the documented range must still be defined behaviour, inf and nan must not look like a result
+	const float inf = std::numeric_limits<float>::infinity();
+	const float huge[] = { 3e9f, -3e9f, 1e30f, -1e30f, 1.f, inf, -inf, std::numeric_limits<float>::quiet_NaN(), 2.f };
+	float huge_sines[9], huge_cosines[9];
+	sincos_batch(huge, huge_sines, huge_cosines, 9);
+	for (size_t i = 5; i < 8; ++i)
+	{
+		if (std::isfinite(huge_sines[i]) || std::isfinite(huge_cosines[i]))
+		{
+			std::printf("sincos_batch(%g) gave a finite result FAILED\n", huge[i]);
+			++failures;
+		}
+	}
+	float sine, cosine;
+	fast_sincos(3e9f, sine, cosine);
+
+	constexpr size_t count = 10007;
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> distribution(-50.f, 50.f);
+
+	std::vector<float> ax(count), ay(count), bx(count), by(count), out(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		ax[i] = distribution(rng); ay[i] = distribution(rng);
+		bx[i] = distribution(rng); by[i] = distribution(rng);
+	}
+	ax[3] = 0.f; ay[3] = 0.f; // a zero vector for normalize_batch
+
+	double max_error = 0.0;
+	dot_batch(ax.data(), ay.data(), bx.data(), by.data(), out.data(), count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		// relative to the size of the products, the sum itself can cancel to near zero
+		const double magnitude = std::max(1.0, std::abs(static_cast<double>(ax[i]) * bx[i]) + std::abs(static_cast<double>(ay[i]) * by[i]));
+		const double expected = static_cast<double>(ax[i]) * bx[i] + static_cast<double>(ay[i]) * by[i];
+		max_error = std::max(max_error, std::abs(out[i] - expected) / magnitude);
+	}
+	check_error("dot_batch", max_error, 1e-6);
+
+	max_error = 0.0;
+	length_batch(ax.data(), ay.data(), out.data(), count);
+	for (size_t i = 0; i < count; ++i)
+		max_error = std::max(max_error, relative_error(out[i], std::hypot(static_cast<double>(ax[i]), static_cast<double>(ay[i]))));
+	check_error("length_batch", max_error, 1e-6);
+
+	max_error = 0.0;
+	dist_squared_batch(ax.data(), ay.data(), bx.data(), by.data(), out.data(), count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		const double dx = static_cast<double>(bx[i]) - ax[i];
+		const double dy = static_cast<double>(by[i]) - ay[i];
+		max_error = std::max(max_error, relative_error(out[i], dx * dx + dy * dy));
+	}
+	check_error("dist_squared_batch", max_error, 1e-6);
+
+	max_error = 0.0;
+	std::vector<float> positive(count);
+	for (size_t i = 0; i < count; ++i)
+		positive[i] = std::abs(ax[i]) + 0.01f;
+	rsqrt_batch(positive.data(), out.data(), count);
+	for (size_t i = 0; i < count; ++i)
+		max_error = std::max(max_error, std::abs(out[i] * std::sqrt(static_cast<double>(positive[i])) - 1.0));
+	check_error("rsqrt_batch", max_error, 1e-5);
+
+	// every special value in every lane position, so the SIMD lanes and the scalar tail are compared alike
+	const float specials[] = { 0.f, -0.f, std::numeric_limits<float>::infinity(), std::numeric_limits<float>::denorm_min(), 1e-40f, -1.f };
+	for (const float special : specials)
+	{
+		for (size_t position = 0; position < 9; ++position)
+		{
+			std::vector<float> input(9, 4.f), result(9);
+			input[position] = special;
+			rsqrt_batch(input.data(), result.data(), input.size());
+
+			if (!same_float(result[position], 1.f / std::sqrt(special)) || std::abs(result[(position + 1) % 9] - 0.5f) > 1e-6f)
+			{
+				std::printf("rsqrt_batch(%g) at position %zu gave %g, expected %g FAILED\n", special, position,
+					result[position], 1.f / std::sqrt(special));
+				++failures;
+			}
+		}
+	}
+
+	max_error = 0.0;
+	std::vector<float> x = ax, y = ay;
+	normalize_batch(x.data(), y.data(), count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		const double length = std::hypot(static_cast<double>(ax[i]), static_cast<double>(ay[i]));
+		const double expected_x = length > 0.0 ? ax[i] / length : 0.0;
+		const double expected_y = length > 0.0 ? ay[i] / length : 0.0;
+		max_error = std::max(max_error, std::abs(x[i] - expected_x) + std::abs(y[i] - expected_y));
+	}
+	check_error("normalize_batch", max_error, 1e-5);
+
+	max_error = 0.0;
+	x = ax; y = ay;
+	clamp_length_batch(x.data(), y.data(), 20.f, count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		const double length = std::hypot(static_cast<double>(ax[i]), static_cast<double>(ay[i]));
+		const double scale = length > 20.0 ? 20.0 / length : 1.0;
+		max_error = std::max(max_error, std::abs(x[i] - ax[i] * scale) + std::abs(y[i] - ay[i] * scale));
+	}
+	check_error("clamp_length_batch", max_error, 1e-4);
+
+	max_error = 0.0;
+	constexpr double two_pi = 6.28318530717958647692;
+	std::vector<float> angles(count);
+	for (size_t i = 0; i < count; ++i)
+		angles[i] = distribution(rng) * 20.f;
+	std::vector<float> wrapped = angles;
+	wrap_angles_batch(wrapped.data(), count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (!(wrapped[i] >= 0.f && wrapped[i] < static_cast<float>(two_pi)))
+		{
+			std::printf("wrap_angles_batch(%g) = %g is outside [0, 2pi) FAILED\n", angles[i], wrapped[i]);
+			++failures;
+		}
+
+		double expected = std::fmod(static_cast<double>(angles[i]), two_pi);
+		if (expected < 0.0)
+			expected += two_pi;
+		const double difference = std::abs(wrapped[i] - expected);
+		max_error = std::max(max_error, std::min(difference, two_pi - difference));
+	}
+	check_error("wrap_angles_batch", max_error, 1e-4);
+
+	std::printf("%d failure(s)\n", failures);
+	return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+#include <cstddef>
+
+#include "simd_math.h"
+
+/*
+	simd_triangles
+- create_triangles(), the bulk version of create_triangle() in utility_SFML.h, for drawing many oriented triangles
+- kept out of utility_SFML.h because simd_math.h needs C++20, utility_SFML.h still builds as C++17
+
+	std::vector<sf::Vertex> vertices(count * 3, sf::Vertex({}, sf::Color::Green));
+	create_triangles(x.data(), y.data(), angle.data(), &width, &height, count, vertices.data(), 0);
+	window.draw(vertices.data(), vertices.size(), sf::Triangles);
+*/
+
+// bulk version of create_triangle over structure of arrays, writes 3 vertices per triangle into out (draw as sf::Triangles)
+// width / height hold either one value per triangle or, when size_stride is 0, a single value shared by all of them
+// only the vertex positions are written so colours can be set once and the buffer reused every frame
+// sincos, the corner maths and the position stores all run in SIMD lanes, see simd::for_each_lane
+template<TrigAccuracy Accuracy = TrigAccuracy::Balanced>
+void create_triangles(const float* center_x, const float* center_y, const float* orientation,
+	const float* width, const float* height, const size_t count, sf::Vertex* out, const size_t size_stride = 1)
+{
+	static_assert(sizeof(sf::Vertex) % sizeof(float) == 0);
+	constexpr size_t vertex_stride = sizeof(sf::Vertex) / sizeof(float);
+
+	simd::for_each_lane(count, [&]<typename V>(const size_t i)
+	{
+		const auto load_size = [&](const float* sizes)
+		{
+			if (size_stride == 0)
+				return V::set(sizes[0]);
+			if (size_stride == 1)
+				return V::load(sizes + i);
+
+			alignas(32) float gathered[V::width];
+			for (size_t lane = 0; lane < V::width; ++lane)
+				gathered[lane] = sizes[(i + lane) * size_stride];
+			return V::load(gathered);
+		};
+
+		typename V::Float s, c;
+		simd::sincos<Accuracy, V>(V::load(orientation + i), s, c);
+
+		const typename V::Float half_w = V::mul(load_size(width), V::set(0.5f));
+		const typename V::Float half_h = V::mul(load_size(height), V::set(0.5f));
+		const typename V::Float x = V::load(center_x + i);
+		const typename V::Float y = V::load(center_y + i);
+
+		// the three corners of create_triangle, (-w/2, h/2), (w/2, h/2), (0, -h/2), share these terms
+		const typename V::Float cw = V::mul(c, half_w), sw = V::mul(s, half_w);
+		const typename V::Float ch = V::mul(c, half_h), sh = V::mul(s, half_h);
+
+		// lane k's corners go to vertices (i + k) * 3 .. + 2
+		float* positions = &out[i * 3].position.x;
+		V::store_pairs(positions, vertex_stride * 3, V::sub(V::sub(x, cw), sh), V::add(V::sub(y, sw), ch));
+		V::store_pairs(positions + vertex_stride, vertex_stride * 3, V::sub(V::add(x, cw), sh), V::add(V::add(y, sw), ch));
+		V::store_pairs(positions + vertex_stride * 2, vertex_stride * 3, V::add(x, sh), V::sub(y, ch));
+	});
+}
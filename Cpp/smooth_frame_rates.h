@@ -2,46 +2,49 @@
 
 #include <array> // Include for std::array
 #include <chrono> // Include for std::chrono
+#include <cstdint>
 
 // A utility class for smoothing out frame rates by calculating the average frame rate across multiple frames
+// frame times are measured in microseconds and summed as they arrive, so querying the average is O(1)
+// see frame_time_stats.h for percentiles and variance
 template<size_t Resolution>
 class FrameRateSmoothing
 {
-    std::array<unsigned, Resolution> frame_rates_array_;
+    std::array<uint64_t, Resolution> frame_times_array_;
+    uint64_t frame_times_sum_ = 0;
     size_t current_index_ = 0;
     size_t current_size_ = 0;
     std::chrono::steady_clock::time_point last_frame_time_;
 
 public:
     // Constructor
-    FrameRateSmoothing() : frame_rates_array_{}, last_frame_time_(std::chrono::steady_clock::now()) {}
+    FrameRateSmoothing() : frame_times_array_{}, last_frame_time_(std::chrono::steady_clock::now()) {}
 
-    // Get the average frame rate
+    // Get the average frame rate, the number of frames divided by the time they took
     [[nodiscard]] float get_average_frame_rate() const
     {
-        if (current_size_ == 0) return 0.0f;
+        if (frame_times_sum_ == 0) return 0.0f;
 
-        unsigned sum = 0;
-        for (size_t i = 0; i < current_size_; ++i)
-            sum += frame_rates_array_[i];
-
-        return static_cast<float>(sum) / static_cast<float>(current_size_);
+        return static_cast<float>(1'000'000.0 * static_cast<double>(current_size_) / static_cast<double>(frame_times_sum_));
     }
 
     // Update frame rate array
     void update_frame_rate()
     {
 	    const auto current_time = std::chrono::steady_clock::now();
-	    const auto elapsed_time = std::chrono::duration_cast<std::chrono::milliseconds>(current_time - last_frame_time_);
+	    const auto elapsed_time = std::chrono::duration_cast<std::chrono::microseconds>(current_time - last_frame_time_);
 
         if (elapsed_time.count() > 0)
         {
-            unsigned frame_rate = 1000 / static_cast<unsigned>(elapsed_time.count());
+            const auto frame_time = static_cast<uint64_t>(elapsed_time.count());
 
             if (current_size_ < Resolution)
                 ++current_size_;
+            else
+                frame_times_sum_ -= frame_times_array_[current_index_];
 
-            frame_rates_array_[current_index_] = frame_rate;
+            frame_times_array_[current_index_] = frame_time;
+            frame_times_sum_ += frame_time;
             current_index_ = (current_index_ + 1) % Resolution;
 
             last_frame_time_ = current_time;
@@ -1,15 +1,31 @@
 #pragma once
 
+#ifdef SPATIAL_GRID_NO_GRAPHICS
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+#else
 #include <SFML/Graphics.hpp>
+#endif
 
+#include <algorithm>
+#include <charconv>
 #include <cstdint>
 #include <iostream>
 #include <array>
+#include <string_view>
+#include <vector>
+
+#ifndef SPATIAL_GRID_NO_GRAPHICS
+#include "text_batch.h"
+#endif
 
 /*
 	SpatialGrid
-- have no more than 65,536 (2^16) objects
+- have no more than 4,294,967,296 (2^32) objects, obj_idx is 32 bit
 - if experiencing error make sure your objects don't go out of bounds
+- the bounds are grown by padding (1 unit by default) to stop out-of-range errors, pass 0 for cells of exactly
+  bounds / Cells, positions which round onto the far edge are then clamped into the last cell
+- define SPATIAL_GRID_NO_GRAPHICS to drop the debug rendering, the grid then only needs the SFML headers and no SFML libraries
 */
 
 // make cell grid 2d
@@ -20,7 +36,7 @@
 using cell_idx = uint32_t;
 using obj_idx = uint32_t;
 
-// maximum number of objects a cell can hold
+// slots per cell, once a cell is full its last slot is overwritten so it holds at most cell_capacity - 1 objects
 static constexpr uint8_t cell_capacity = 25;
 
 
@@ -29,22 +45,24 @@ template<size_t CellsX, size_t CellsY>
 class SpatialGrid
 {
 public:
-	explicit SpatialGrid(const sf::FloatRect screen_size = {}) : m_screenSize(screen_size)
+	explicit SpatialGrid(const sf::FloatRect screen_size = {}, const float padding = 1.f) : m_screenSize(screen_size)
 	{
 		objects_count.resize(total_cells, 0);
 		grid.resize(total_cells, std::array<cell_idx, cell_capacity>());
 
-		init_graphics();
+		init_graphics(padding);
+#ifndef SPATIAL_GRID_NO_GRAPHICS
 		initVertexBuffer();
 		initFont();
+#endif
 	}
 	~SpatialGrid() = default;
 
 
 	cell_idx inline hash(const float x, const float y) const
 	{
-		const auto cell_x = static_cast<cell_idx>(x / m_cellSize.x);
-		const auto cell_y = static_cast<cell_idx>(y / m_cellSize.y);
+		const auto cell_x = std::min(static_cast<cell_idx>(x / m_cellSize.x), static_cast<cell_idx>(CellsX - 1));
+		const auto cell_y = std::min(static_cast<cell_idx>(y / m_cellSize.y), static_cast<cell_idx>(CellsY - 1));
 		return cell_y * CellsX + cell_x;
 	}
 
@@ -72,25 +90,86 @@ public:
 	}
 
 
+	// calls func(obj_id) for every object in the cells overlapping rect, cells outside the grid are ignored
+	template<typename Func>
+	void for_each_in_rect(const sf::FloatRect& rect, Func&& func) const
+	{
+		if (rect.left + rect.width < 0.f || rect.top + rect.height < 0.f ||
+			rect.left >= m_cellSize.x * CellsX || rect.top >= m_cellSize.y * CellsY)
+			return;
+
+		const size_t min_x = clamp_cell(rect.left / m_cellSize.x, CellsX);
+		const size_t min_y = clamp_cell(rect.top / m_cellSize.y, CellsY);
+		const size_t max_x = clamp_cell((rect.left + rect.width) / m_cellSize.x, CellsX);
+		const size_t max_y = clamp_cell((rect.top + rect.height) / m_cellSize.y, CellsY);
+
+		for (size_t y = min_y; y <= max_y; ++y)
+		{
+			for (size_t x = min_x; x <= max_x; ++x)
+			{
+				const cell_idx index = static_cast<cell_idx>(y * CellsX + x);
+				const auto& cell = grid[index];
+				for (uint8_t i = 0; i < objects_count[index]; ++i)
+				{
+					func(cell[i]);
+				}
+			}
+		}
+	}
+
+
+	// appends the ids of every object in the cells overlapping rect to out
+	template<typename Container>
+	void query_rect(const sf::FloatRect& rect, Container& out) const
+	{
+		for_each_in_rect(rect, [&out](const obj_idx id) { out.push_back(id); });
+	}
+
+
+#ifndef SPATIAL_GRID_NO_GRAPHICS
 	void render_grid(sf::RenderWindow& window)
 	{
 		window.draw(vertexBuffer);
 
-		// rendering the locations of each cell with their content counts
-		for (int x = 0; x < CellsX; ++x)
+		// rendering the locations of each cell with their content counts, every label goes into one batch.
+		// each label is composed of cached pieces: the punctuation, "obj count: " and the numbers, so the cache
+		// holds one layout per number up to max(CellsX, CellsY, cell_capacity) rather than one per cell
+		char buffer[16];
+		const auto add_number = [&](sf::Vector2f& pen, const size_t number)
+		{
+			const char* end = std::to_chars(buffer, std::end(buffer), number).ptr;
+			pen.x += text_batch.add(pen, std::string_view(buffer, end - buffer));
+		};
+
+		for (size_t x = 0; x < CellsX; ++x)
 		{
-			for (int y = 0; y < CellsY; ++y)
+			for (size_t y = 0; y < CellsY; ++y)
 			{
-				const cell_idx index = y * CellsX + x;
-				const sf::Vector2f topleft = { x * m_cellSize.x, y * m_cellSize.y };
-				text.setString("(" + std::to_string(x) + ", " + std::to_string(y) + ")  obj count: " + std::to_string(objects_count[index]));
-				text.setPosition(topleft);
-				window.draw(text);
+				const cell_idx index = static_cast<cell_idx>(y * CellsX + x);
+				sf::Vector2f pen = { static_cast<float>(x) * m_cellSize.x, static_cast<float>(y) * m_cellSize.y };
+
+				pen.x += text_batch.add(pen, "(");
+				add_number(pen, x);
+				pen.x += text_batch.add(pen, ", ");
+				add_number(pen, y);
+				pen.x += text_batch.add(pen, ")  obj count: ");
+				add_number(pen, objects_count[index]);
 			}
 		}
+
+		text_batch.flush(window);
 	}
+#endif
 
 private:
+	static size_t clamp_cell(const float cell, const size_t cells)
+	{
+		if (cell <= 0.f)
+			return 0;
+		return std::min(static_cast<size_t>(cell), cells - 1);
+	}
+
+#ifndef SPATIAL_GRID_NO_GRAPHICS
 	void initVertexBuffer()
 	{
 		std::vector<sf::Vertex> vertices(static_cast<std::vector<sf::Vertex>::size_type>((CellsX + CellsY) * 2));
@@ -125,24 +204,21 @@ private:
 
 	void initFont()
 	{
-		constexpr int char_size = 45;
 		const std::string font_location = "fonts/Calibri.ttf";
 		if (!font.loadFromFile(font_location))
 		{
 			std::cerr << "[ERROR]: Failed to load font from: " << font_location << '\n';
-			return;
 		}
-		text = sf::Text("", font, char_size);
 	}
+#endif
 
-	void init_graphics()
+	void init_graphics(const float padding)
 	{
 		// increasing the size of the boundaries very slightly stops any out-of-range errors 
-		constexpr float resize = 1.f;
-		m_screenSize.left -= resize;
-		m_screenSize.top -= resize;
-		m_screenSize.width += resize;
-		m_screenSize.height += resize;
+		m_screenSize.left -= padding;
+		m_screenSize.top -= padding;
+		m_screenSize.width += padding;
+		m_screenSize.height += padding;
 
 		m_cellSize = { m_screenSize.width / static_cast<float>(CellsX),
 						  m_screenSize.height / static_cast<float>(CellsY) };
@@ -157,9 +233,13 @@ public:
 	sf::Vector2f m_cellSize{};
 	sf::FloatRect m_screenSize{};
 
+#ifndef SPATIAL_GRID_NO_GRAPHICS
 	sf::VertexBuffer vertexBuffer{};
 	sf::Font font;
-	sf::Text text;
+
+	static constexpr unsigned font_size = 45;
+	TextBatch text_batch{ font, font_size, std::max({ CellsX, CellsY, static_cast<size_t>(cell_capacity) }) + 3 };
+#endif
 
 	alignas(32) std::vector<std::array<obj_idx, cell_capacity>> grid{};
 	alignas(32) std::vector<uint8_t> objects_count{};
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <iostream>
+#include <string_view>
+#include <type_traits>
+
+#include "text_batch.h"
+
+/*
+	StatsOverlay
+- a HUD of "label: value" fields which does no heap allocation per frame once it is running
+- fields are registered once with add_field(), set() then formats the value with std::to_chars into the field's fixed buffer
+- a field whose value hasn't changed is not reformatted, and text() is only rebuilt when a field changed
+- draw() queues every field into a TextBatch: the labels stay cached, each value keeps its own layout
+  which is only rebuilt when set() changed the value (or the batch's character size changed)
+- sf::Font allocates the first time it renders a glyph at a character size, so for no allocation at all call
+  preload_glyphs() once after the batch's font and character size are set, a value can then use any character
+
+	StatsOverlay<8> overlay;
+	const size_t fps_field = overlay.add_field("fps", 0);
+	StatsOverlay<8>::preload_glyphs(batch);
+	...
+	overlay.set(fps_field, stats.fps());
+	overlay.draw(batch, { 10.f, 10.f }, 24.f);
+*/
+
+template<size_t MaxFields, size_t FieldLength = 32>
+class StatsOverlay
+{
+	struct Field
+	{
+		std::array<char, FieldLength + 2> heading{}; // "label: "
+		size_t heading_length = 0;
+
+		std::array<char, FieldLength> value{};
+		size_t value_length = 0;
+
+		double last_value = std::nan("");
+		int precision = 2;
+
+		TextBatch::Layout value_layout;
+		unsigned layout_character_size = 0; // 0 until the value has been laid out
+	};
+
+	std::array<Field, MaxFields> fields_{};
+	size_t field_count_ = 0;
+
+	// "label: value, label: value" of every field, like format_variables()
+	std::array<char, MaxFields * (FieldLength * 2 + 4)> text_{};
+	size_t text_length_ = 0;
+	bool text_dirty_ = true;
+
+public:
+	// returned by add_field() once all MaxFields are taken, set() ignores it
+	static constexpr size_t invalid_field = MaxFields;
+
+	// returns the handle used by set(), labels longer than FieldLength are cut short
+	size_t add_field(const std::string_view label, const int precision = 2)
+	{
+		if (field_count_ >= MaxFields)
+		{
+			std::cerr << "[ERROR]: StatsOverlay is full, field " << label << " was not added" << '\n';
+			return invalid_field;
+		}
+
+		Field& field = fields_[field_count_];
+		const size_t label_length = std::min(label.size(), FieldLength);
+		std::copy_n(label.data(), label_length, field.heading.data());
+		field.heading[label_length] = ':';
+		field.heading[label_length + 1] = ' ';
+		field.heading_length = label_length + 2;
+		field.precision = precision;
+
+		text_dirty_ = true;
+		return field_count_++;
+	}
+
+	template<typename T>
+	void set(const size_t field_index, const T value)
+	{
+		if (field_index >= field_count_)
+			return;
+
+		Field& field = fields_[field_index];
+		const auto as_double = static_cast<double>(value);
+		if (as_double == field.last_value)
+			return;
+
+		field.last_value = as_double;
+
+		std::to_chars_result result;
+		if constexpr (std::is_integral_v<T>)
+			result = std::to_chars(field.value.data(), field.value.data() + FieldLength, value);
+		else
+			result = std::to_chars(field.value.data(), field.value.data() + FieldLength, as_double, std::chars_format::fixed, field.precision);
+
+		// a value too long for the buffer shows as '#' rather than garbage
+		if (result.ec != std::errc())
+		{
+			field.value[0] = '#';
+			result.ptr = field.value.data() + 1;
+		}
+
+		field.value_length = static_cast<size_t>(result.ptr - field.value.data());
+		field.layout_character_size = 0;
+		text_dirty_ = true;
+	}
+
+	[[nodiscard]] std::string_view label(const size_t field_index) const
+	{
+		return { fields_[field_index].heading.data(), fields_[field_index].heading_length - 2 };
+	}
+
+	[[nodiscard]] std::string_view value(const size_t field_index) const
+	{
+		return { fields_[field_index].value.data(), fields_[field_index].value_length };
+	}
+
+	[[nodiscard]] std::string_view text()
+	{
+		if (text_dirty_)
+			rebuild_text();
+		return { text_.data(), text_length_ };
+	}
+
+	[[nodiscard]] size_t size() const { return field_count_; }
+
+	// every character set() can write: digits, sign, point, the '#' of a value too long and "inf" / "nan"
+	static constexpr std::string_view value_characters = "0123456789.-#infa";
+
+	// lays every value character out once so the font has their glyphs before draw() needs them
+	static void preload_glyphs(const TextBatch& batch)
+	{
+		TextBatch::Layout layout;
+		batch.build_layout(value_characters, layout);
+	}
+
+
+	// one field per line starting at position
+	void draw(TextBatch& batch, const sf::Vector2f position, const float line_spacing, const sf::Color color = sf::Color::White)
+	{
+		for (size_t i = 0; i < field_count_; ++i)
+		{
+			Field& field = fields_[i];
+			if (field.layout_character_size != batch.character_size())
+			{
+				batch.build_layout(value(i), field.value_layout);
+				field.layout_character_size = batch.character_size();
+			}
+
+			const sf::Vector2f line_position = { position.x, position.y + line_spacing * static_cast<float>(i) };
+			const float label_width = batch.add(line_position, heading(i), color);
+			batch.add_layout({ line_position.x + label_width, line_position.y }, field.value_layout, color);
+		}
+	}
+
+private:
+	[[nodiscard]] std::string_view heading(const size_t field_index) const
+	{
+		return { fields_[field_index].heading.data(), fields_[field_index].heading_length };
+	}
+
+	void rebuild_text()
+	{
+		text_length_ = 0;
+		for (size_t i = 0; i < field_count_; ++i)
+		{
+			if (i > 0)
+				append(", ");
+			append(heading(i));
+			append(value(i));
+		}
+		text_dirty_ = false;
+	}
+
+	void append(const std::string_view part)
+	{
+		const size_t length = std::min(part.size(), text_.size() - text_length_);
+		std::copy_n(part.data(), length, text_.data() + text_length_);
+		text_length_ += length;
+	}
+};
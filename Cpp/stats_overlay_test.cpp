@@ -0,0 +1,99 @@
+/*
+	stats_overlay_test
+- checks that a running StatsOverlay does no heap allocation: every operator new is counted while
+  set(), text() and draw() run for many frames after a warm up frame
+- also checks the formatting and that a full overlay hands out an invalid handle which set() ignores
+- draw() lays text out with the font given as the first argument, or with an empty sf::Font when there is none,
+  the glyphs are preloaded so a real font doesn't allocate when the loop first draws a digit
+
+	c++ -O2 -std=c++20 stats_overlay_test.cpp -o stats_overlay_test -lsfml-graphics -lsfml-window -lsfml-system
+	./stats_overlay_test ../fonts/Calibri.ttf
+*/
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string_view>
+
+#include "stats_overlay.h"
+
+static std::atomic<size_t> allocations{ 0 };
+
+void* operator new(const size_t size)
+{
+	++allocations;
+	if (void* pointer = std::malloc(size == 0 ? 1 : size))
+		return pointer;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, size_t) noexcept { std::free(pointer); }
+
+
+static int failures = 0;
+
+static void check(const bool condition, const char* what)
+{
+	if (!condition)
+	{
+		std::printf("FAILED: %s\n", what);
+		++failures;
+	}
+}
+
+
+int main(const int argc, char** argv)
+{
+	sf::Font font;
+	if (argc > 1 && !font.loadFromFile(argv[1]))
+		std::printf("could not load %s, drawing with an empty font\n", argv[1]);
+
+	TextBatch batch(font, 20);
+	StatsOverlay<4> overlay;
+	const size_t fps_field = overlay.add_field("fps", 1);
+	const size_t entities_field = overlay.add_field("entities", 0);
+	const size_t update_field = overlay.add_field("update ms", 2);
+
+	overlay.set(fps_field, 59.94);
+	overlay.set(entities_field, 12000);
+	overlay.set(update_field, 3.14159);
+	check(overlay.text() == "fps: 59.9, entities: 12000, update ms: 3.14", "formatted text");
+
+	// sf::Font allocates for each glyph it hasn't rendered yet, the loop below uses digits the first frame doesn't
+	StatsOverlay<4>::preload_glyphs(batch);
+
+	// a warm up frame grows the batch's vertex buffer, the label cache and the value layouts to their working size
+	overlay.draw(batch, { 10.f, 10.f }, 24.f);
+	batch.clear();
+
+	const size_t before = allocations.load();
+	for (int frame = 0; frame < 10000; ++frame)
+	{
+		overlay.set(fps_field, 50.0 + frame % 10);
+		overlay.set(entities_field, 10000 + frame % 100);
+		overlay.set(update_field, 1.0 + (frame % 7) * 0.25);
+
+		const std::string_view text = overlay.text();
+		check(!text.empty(), "text while running");
+
+		overlay.draw(batch, { 10.f, 10.f }, 24.f);
+		batch.clear();
+	}
+	const size_t running_allocations = allocations.load() - before;
+	check(running_allocations == 0, "no allocations while running");
+
+	// a full overlay must not hand out a handle to another field
+	overlay.add_field("last", 0);
+	const size_t overflow_field = overlay.add_field("overflow", 0);
+	check(overflow_field == StatsOverlay<4>::invalid_field, "full overlay returns invalid_field");
+
+	overlay.set(overflow_field, 123);
+	overlay.set(fps_field, 60.0);
+	check(overlay.value(fps_field) == "60.0", "set() ignores the invalid handle");
+	check(overlay.size() == 4, "field count");
+
+	std::printf("%zu allocations over 10000 frames, %d failure(s)\n", running_allocations, failures);
+	return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
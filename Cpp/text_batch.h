@@ -0,0 +1,223 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/*
+	TextBatch
+- draws any number of labels of one font and character size with a single draw call
+- glyph quads are built the same way sf::Text builds them, straight from the font's glyph atlas texture
+- the layout of each distinct string is cached, an unchanged label costs one hash lookup and a vertex copy
+- strings which change every frame can use add_uncached() so they don't churn the cache
+- the cache is emptied once it holds max_cached_layouts strings
+- callers can also keep a Layout of their own from build_layout() and queue it with add_layout()
+
+	TextBatch labels(font, 20);
+	labels.add({ 10.f, 10.f }, "hello");
+	labels.flush(window);
+*/
+
+class TextBatch
+{
+public:
+	struct Layout
+	{
+		std::vector<sf::Vertex> vertices; // white, relative to the label's position
+		sf::Vector2f size;
+		float advance = 0.f;
+	};
+
+private:
+	// lets the cache be searched with a string_view without building a std::string
+	struct StringHash
+	{
+		using is_transparent = void;
+		size_t operator()(const std::string_view text) const { return std::hash<std::string_view>{}(text); }
+	};
+
+	const sf::Font* font_;
+	unsigned character_size_;
+	size_t max_cached_layouts_;
+
+	std::unordered_map<std::string, Layout, StringHash, std::equal_to<>> cache_;
+	Layout scratch_layout_;
+	std::vector<sf::Vertex> vertices_;
+
+public:
+	TextBatch(const sf::Font& font, const unsigned character_size, const size_t max_cached_layouts = 4096)
+		: font_(&font), character_size_(character_size), max_cached_layouts_(max_cached_layouts) {}
+
+
+	// queues a label and returns its advance, the x offset at which a following label would continue
+	float add(const sf::Vector2f& position, const std::string_view text, const sf::Color color = sf::Color::White, const bool centered = false)
+	{
+		auto it = cache_.find(text);
+		if (it == cache_.end())
+		{
+			if (cache_.size() >= max_cached_layouts_)
+				cache_.clear();
+
+			it = cache_.emplace(std::string(text), Layout{}).first;
+			build_layout(text, it->second);
+		}
+
+		append(it->second, position, color, centered);
+		return it->second.advance;
+	}
+
+	// as add() but lays the string out every call, for text that rarely repeats (timers, counters)
+	float add_uncached(const sf::Vector2f& position, const std::string_view text, const sf::Color color = sf::Color::White, const bool centered = false)
+	{
+		build_layout(text, scratch_layout_);
+		append(scratch_layout_, position, color, centered);
+		return scratch_layout_.advance;
+	}
+
+
+	// queues a layout made by build_layout(), for callers which know better than the cache when their text changes
+	float add_layout(const sf::Vector2f& position, const Layout& layout, const sf::Color color = sf::Color::White, const bool centered = false)
+	{
+		append(layout, position, color, centered);
+		return layout.advance;
+	}
+
+
+	void draw(sf::RenderTarget& target, sf::RenderStates render_states = sf::RenderStates()) const
+	{
+		if (vertices_.empty())
+			return;
+
+		render_states.texture = &font_->getTexture(character_size_);
+		target.draw(vertices_.data(), vertices_.size(), sf::Triangles, render_states);
+	}
+
+	// empties the queued labels, keeping the memory for the next frame
+	void clear() { vertices_.clear(); }
+
+	void flush(sf::RenderTarget& target, const sf::RenderStates& render_states = sf::RenderStates())
+	{
+		draw(target, render_states);
+		clear();
+	}
+
+	void set_character_size(const unsigned character_size)
+	{
+		if (character_size == character_size_)
+			return;
+
+		character_size_ = character_size;
+		clear_cache();
+	}
+
+	void clear_cache() { cache_.clear(); }
+
+	[[nodiscard]] unsigned character_size() const { return character_size_; }
+
+private:
+	void append(const Layout& layout, sf::Vector2f position, const sf::Color color, const bool centered)
+	{
+		// same centering as Font::draw
+		if (centered)
+		{
+			position.x -= layout.size.x / 2.f;
+			position.y -= layout.size.y / 2.f;
+		}
+
+		const size_t offset = vertices_.size();
+		vertices_.resize(offset + layout.vertices.size());
+
+		for (size_t i = 0; i < layout.vertices.size(); ++i)
+		{
+			const sf::Vertex& source = layout.vertices[i];
+			vertices_[offset + i] = { source.position + position, color, source.texCoords };
+		}
+	}
+
+public:
+	// mirrors sf::Text's geometry: kerning, whitespace and new lines, one padded quad per glyph
+	void build_layout(const std::string_view text, Layout& layout) const
+	{
+		layout.vertices.clear();
+
+		const float whitespace_width = font_->getGlyph(U' ', character_size_, false).advance;
+		const float line_spacing = font_->getLineSpacing(character_size_);
+
+		float x = 0.f;
+		float y = static_cast<float>(character_size_);
+		float min_x = static_cast<float>(character_size_), min_y = static_cast<float>(character_size_);
+		float max_x = 0.f, max_y = 0.f;
+		sf::Uint32 previous = 0;
+
+		for (const char character : text)
+		{
+			const auto current = static_cast<sf::Uint32>(static_cast<unsigned char>(character));
+			if (current == '\r')
+				continue;
+
+			x += font_->getKerning(previous, current, character_size_);
+			previous = current;
+
+			if (current == ' ' || current == '\n' || current == '\t')
+			{
+				min_x = std::min(min_x, x);
+				min_y = std::min(min_y, y);
+
+				if (current == ' ')
+					x += whitespace_width;
+				else if (current == '\t')
+					x += whitespace_width * 4.f;
+				else
+				{
+					y += line_spacing;
+					x = 0.f;
+				}
+
+				max_x = std::max(max_x, x);
+				max_y = std::max(max_y, y);
+				continue;
+			}
+
+			const sf::Glyph& glyph = font_->getGlyph(current, character_size_, false);
+			add_glyph_quad(layout.vertices, { x, y }, glyph);
+
+			min_x = std::min(min_x, x + glyph.bounds.left);
+			max_x = std::max(max_x, x + glyph.bounds.left + glyph.bounds.width);
+			min_y = std::min(min_y, y + glyph.bounds.top);
+			max_y = std::max(max_y, y + glyph.bounds.top + glyph.bounds.height);
+
+			x += glyph.advance;
+		}
+
+		layout.size = text.empty() ? sf::Vector2f() : sf::Vector2f(max_x - min_x, max_y - min_y);
+		layout.advance = x;
+	}
+
+private:
+	static void add_glyph_quad(std::vector<sf::Vertex>& vertices, const sf::Vector2f pen, const sf::Glyph& glyph)
+	{
+		constexpr float padding = 1.f;
+
+		const float left = pen.x + glyph.bounds.left - padding;
+		const float top = pen.y + glyph.bounds.top - padding;
+		const float right = pen.x + glyph.bounds.left + glyph.bounds.width + padding;
+		const float bottom = pen.y + glyph.bounds.top + glyph.bounds.height + padding;
+
+		const float u1 = static_cast<float>(glyph.textureRect.left) - padding;
+		const float v1 = static_cast<float>(glyph.textureRect.top) - padding;
+		const float u2 = static_cast<float>(glyph.textureRect.left + glyph.textureRect.width) + padding;
+		const float v2 = static_cast<float>(glyph.textureRect.top + glyph.textureRect.height) + padding;
+
+		vertices.emplace_back(sf::Vector2f(left, top), sf::Color::White, sf::Vector2f(u1, v1));
+		vertices.emplace_back(sf::Vector2f(right, top), sf::Color::White, sf::Vector2f(u2, v1));
+		vertices.emplace_back(sf::Vector2f(left, bottom), sf::Color::White, sf::Vector2f(u1, v2));
+		vertices.emplace_back(sf::Vector2f(left, bottom), sf::Color::White, sf::Vector2f(u1, v2));
+		vertices.emplace_back(sf::Vector2f(right, top), sf::Color::White, sf::Vector2f(u2, v1));
+		vertices.emplace_back(sf::Vector2f(right, bottom), sf::Color::White, sf::Vector2f(u2, v2));
+	}
+};
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// A small fixed-size worker pool for offloading work from the main / render thread
+// submit() queues a job for the next free worker, wait() blocks until every queued job has finished
+// the destructor finishes any queued jobs before joining the workers
+class ThreadPool
+{
+	std::vector<std::thread> workers_;
+	std::queue<std::function<void()>> jobs_;
+
+	std::mutex mutex_;
+	std::condition_variable job_available_;
+	std::condition_variable jobs_finished_;
+
+	size_t busy_workers_ = 0;
+	bool stopping_ = false;
+
+public:
+	explicit ThreadPool(unsigned thread_count = std::thread::hardware_concurrency())
+	{
+		if (thread_count == 0)
+			thread_count = 1;
+
+		workers_.reserve(thread_count);
+		for (unsigned i = 0; i < thread_count; ++i)
+		{
+			workers_.emplace_back([this] { worker_loop(); });
+		}
+	}
+
+	~ThreadPool()
+	{
+		{
+			std::lock_guard lock(mutex_);
+			stopping_ = true;
+		}
+		job_available_.notify_all();
+
+		for (std::thread& worker : workers_)
+		{
+			worker.join();
+		}
+	}
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+
+	void submit(std::function<void()> job)
+	{
+		{
+			std::lock_guard lock(mutex_);
+			jobs_.push(std::move(job));
+		}
+		job_available_.notify_one();
+	}
+
+	// blocks the calling thread until the queue is empty and no worker is busy
+	void wait()
+	{
+		std::unique_lock lock(mutex_);
+		jobs_finished_.wait(lock, [this] { return jobs_.empty() && busy_workers_ == 0; });
+	}
+
+	// runs func(begin, end) over [0, count) split into one block per worker, then waits like wait() does
+	template<typename Func>
+	void parallel_for(const size_t count, Func&& func)
+	{
+		const size_t blocks = std::min(count, workers_.size());
+		if (blocks <= 1)
+		{
+			if (count > 0)
+				func(size_t{ 0 }, count);
+			return;
+		}
+
+		const size_t block_size = (count + blocks - 1) / blocks;
+		for (size_t begin = 0; begin < count; begin += block_size)
+		{
+			const size_t end = std::min(count, begin + block_size);
+			submit([&func, begin, end] { func(begin, end); });
+		}
+
+		wait();
+	}
+
+	[[nodiscard]] size_t size() const { return workers_.size(); }
+
+
+private:
+	void worker_loop()
+	{
+		while (true)
+		{
+			std::function<void()> job;
+			{
+				std::unique_lock lock(mutex_);
+				job_available_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+
+				if (jobs_.empty()) // only reached once stopping_ is set
+					return;
+
+				job = std::move(jobs_.front());
+				jobs_.pop();
+				++busy_workers_;
+			}
+
+			job();
+
+			{
+				std::lock_guard lock(mutex_);
+				--busy_workers_;
+				if (jobs_.empty() && busy_workers_ == 0)
+					jobs_finished_.notify_all();
+			}
+		}
+	}
+};
@@ -1,28 +1,39 @@
 #pragma once
 
 #include <SFML/Graphics.hpp>
+#include <charconv>
 #include <cmath> 
 #include <chrono>
+#include <string>
+#include <string_view>
 
 
+// for per-frame HUDs prefer StatsOverlay (stats_overlay.h) which doesn't allocate at all
 inline std::string format_variables(const std::vector<std::pair<std::string, double>>& variables) {
-	std::ostringstream oss;
-	oss.precision(2);
-	oss << std::fixed;
+	std::string result;
+	result.reserve(variables.size() * 24);
+
+	char buffer[32];
 	for (const auto& [fst, snd] : variables) {
-		oss << fst << ": " << snd << ", ";
+		const auto [end, ec] = std::to_chars(std::begin(buffer), std::end(buffer), snd, std::chars_format::fixed, 2);
+		result.append(fst).append(": ").append(buffer, ec == std::errc() ? end : buffer).append(", ");
 	}
-	const std::string result = oss.str();
+
 	// Remove the last comma and space
-	return result.substr(0, result.size() - 2);
+	if (!result.empty())
+		result.resize(result.size() - 2);
+	return result;
 }
 
 
 inline void caption_frame_rate(sf::RenderWindow& window, const std::string& title, const int fps)
 {
-	std::ostringstream oss;
-	oss << title << " " << fps << "fps \n";
-	const std::string string_frame_rate = oss.str();
+	char buffer[16];
+	char* end = std::to_chars(std::begin(buffer), std::end(buffer), fps).ptr;
+
+	std::string string_frame_rate;
+	string_frame_rate.reserve(title.size() + 24);
+	string_frame_rate.append(title).append(" ").append(buffer, end).append("fps \n");
 	window.setTitle(string_frame_rate);
 }
 
@@ -35,24 +46,33 @@ T round_to_nearest_n(const T value, const unsigned decimal_places) {
 
 
 template<typename T>
-std::string trim_decimal_to_string(const T number, const size_t precision, const bool round=true)
+std::string trim_decimal_to_string(T number, const size_t precision, const bool round=true)
 {
-	if (round)
-		number = round_to_nearest_n(number, precision);
+	char buffer[64];
+	char* end;
 
-	// Convert the double to a string with the specified precision
-	std::string result = std::to_string(number);
-
-	if (const size_t dot_position = result.find('.'); dot_position != std::string::npos)
+	if constexpr (std::is_integral_v<T>)
+	{
+		end = std::to_chars(std::begin(buffer), std::end(buffer), number).ptr;
+	}
+	else
 	{
-		// Check if there are enough characters after the dot
-		if (result.length() - dot_position > precision + 1)
+		if (round)
+			number = round_to_nearest_n(number, static_cast<unsigned>(precision));
+
+		// Convert to a string with 6 decimals (as std::to_string would) then cut it down to the precision
+		const auto result = std::to_chars(std::begin(buffer), std::end(buffer), number, std::chars_format::fixed, 6);
+		end = result.ec == std::errc() ? result.ptr : buffer;
+
+		if (const auto dot = std::string_view(buffer, end - buffer).find('.'); dot != std::string_view::npos)
 		{
-			result = result.substr(0, dot_position + precision + 1);
+			// Check if there are enough characters after the dot
+			if (static_cast<size_t>(end - buffer) - dot > precision + 1)
+				end = buffer + dot + precision + 1;
 		}
 	}
 
-	return result;
+	return { buffer, end };
 }
 
 
@@ -71,14 +91,14 @@ inline float length(const sf::Vector2f& v)
 inline constexpr float pi = 3.14159265358979323846264338327950f;
 
 
+// wraps the angle into [0, 2pi) in constant time, see wrap_angles_batch in simd_math.h for arrays of angles
 inline void normalize_angle(float& angle_radians)
 {
-	while (angle_radians < 0.f)
-	{
+	angle_radians -= 2.f * pi * std::floor(angle_radians / (2.f * pi));
+
+	// rounding can land a hair outside the range
+	if (angle_radians < 0.f)
 		angle_radians += 2.f * pi;
-	}
-	while (angle_radians >= 2.f * pi)
-	{
-		angle_radians -= 2.f * pi;
-	}
+	if (angle_radians >= 2.f * pi)
+		angle_radians = 0.f;
 }
\ No newline at end of file
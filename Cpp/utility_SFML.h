@@ -1,6 +1,6 @@
 #pragma once
 
-#include <SFMl/Graphics.hpp>
+#include <SFML/Graphics.hpp>
 
 inline void draw_rect_outline(sf::Vector2f top_left, sf::Vector2f bottom_right, sf::RenderWindow& window, const sf::RenderStates& render_states = sf::RenderStates())
 {
@@ -110,12 +110,14 @@ inline sf::VertexArray create_triangle(const float center_x, const float center_
 inline void rotate_triangle(sf::VertexArray& triangle, const float angle_radians)
 {
 	const sf::Vector2f pivot = (triangle[0].position + triangle[1].position + triangle[2].position) / 3.0f;
+	const float cos_theta = std::cos(angle_radians);
+	const float sin_theta = std::sin(angle_radians);
 
 	for (size_t i = 0; i < 3; ++i)
 	{
 		const sf::Vector2f new_pos = triangle[i].position - pivot;
-		const float x = new_pos.x * cos(angle_radians) - new_pos.y * sin(angle_radians);
-		const float y = new_pos.x * sin(angle_radians) + new_pos.y * cos(angle_radians);
+		const float x = new_pos.x * cos_theta - new_pos.y * sin_theta;
+		const float y = new_pos.x * sin_theta + new_pos.y * cos_theta;
 		triangle[i].position = sf::Vector2f(x, y) + pivot;
 	}
 }
\ No newline at end of file
@@ -0,0 +1,263 @@
+/*
+	spatial_grid_native
+- python bindings for the C++ SpatialGrid (Cpp/spatial_grid.h) with the surface of SpatialHashGrid in spatial_hash_grid.py
+- positions are numpy arrays of shape (n, 2), float32 C-contiguous arrays are read in place without a copy
+- particles are identified by their row in the positions array, neighbour queries return numpy uint32 arrays of rows
+- SpatialGrid takes its cell counts as template parameters, so every combination of supported_cells is compiled in
+- like the C++ grid a cell holds at most cell_capacity - 1 (24) particles, any more in the same cell are dropped:
+  update_particles() doesn't count them as stored and grid.overflowed says how many there were
+- built with SPATIAL_GRID_NO_GRAPHICS, only the SFML headers are needed, not the libraries
+- the grid is built without padding so its cells are exactly (max - min) / cells, like the python grid's
+- the GIL is released while a grid works so separate grids can be used from separate threads at once, but one grid is
+  not thread safe: don't update_particles() a grid while another thread is querying it
+- test_spatial_grid_native.py compares the results with spatial_hash_grid.py
+
+	c++ -O3 -std=c++20 -shared -fPIC $(python3 -m pybind11 --includes) -I<SFML>/include \
+		spatial_grid_native.cpp -o spatial_grid_native$(python3-config --extension-suffix)
+
+	import numpy as np
+	import spatial_grid_native
+
+	grid = spatial_grid_native.create_grid(1000, 1000, 64, 64)
+	grid.update_particles(positions)                                  # np.float32 array, shape (n, 2)
+	nearby = grid.find_near(positions[0], 50.0)                       # rows near particle 0
+	offsets, rows = grid.find_near_many(positions, 50.0)              # rows[offsets[i]:offsets[i + 1]] are near particle i
+*/
+
+#define SPATIAL_GRID_NO_GRAPHICS
+
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+
+#include <array>
+#include <cmath>
+#include <functional>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../../Cpp/spatial_grid.h"
+
+namespace py = pybind11;
+
+using Positions = py::array_t<float, py::array::c_style | py::array::forcecast>;
+using GridFactory = std::function<py::object(float, float, float, float)>;
+
+
+// hands the vector over to numpy without copying it
+template<typename T>
+py::array_t<T> to_numpy(std::vector<T>&& values)
+{
+	auto* owned = new std::vector<T>(std::move(values));
+	const py::capsule free_when_done(owned, [](void* pointer) { delete static_cast<std::vector<T>*>(pointer); });
+	return py::array_t<T>(static_cast<py::ssize_t>(owned->size()), owned->data(), free_when_done);
+}
+
+
+template<size_t CellsX, size_t CellsY>
+class NativeGrid
+{
+	SpatialGrid<CellsX, CellsY> grid_;
+	sf::Vector2f origin_;
+	sf::Vector2f size_;
+	size_t overflowed_ = 0;
+
+public:
+	// bounds as in spatial_hash_grid.py: [min_x, max_x] by [min_y, max_y]
+	NativeGrid(const float min_x, const float max_x, const float min_y, const float max_y)
+		: grid_({ 0.f, 0.f, max_x - min_x, max_y - min_y }, 0.f), origin_(min_x, min_y), size_(max_x - min_x, max_y - min_y) {}
+
+
+	// rebuilds the grid from every row of positions, returns how many particles were stored:
+	// inside the bounds and in a cell which wasn't full
+	size_t update_particles(const Positions& positions)
+	{
+		const auto rows = check_positions(positions);
+		size_t stored = 0;
+		overflowed_ = 0;
+
+		py::gil_scoped_release release;
+		grid_.clear();
+
+		for (py::ssize_t i = 0; i < rows.shape(0); ++i)
+		{
+			const float x = rows(i, 0) - origin_.x;
+			const float y = rows(i, 1) - origin_.y;
+
+			// outside particles are skipped like the python version does, the C++ grid would index out of range
+			if (!(x >= 0.f && y >= 0.f && x < size_.x && y < size_.y))
+				continue;
+
+			// the C++ grid keeps overwriting the last slot of a full cell, which is never read back
+			if (grid_.objects_count[grid_.hash(x, y)] >= cell_capacity - 1)
+			{
+				++overflowed_;
+				continue;
+			}
+
+			grid_.add_object(x, y, static_cast<size_t>(i));
+			++stored;
+		}
+
+		return stored;
+	}
+
+
+	// rows of every particle in the cells overlapping the square of half size visual_range around position
+	py::array_t<uint32_t> find_near(const std::array<float, 2> position, const float visual_range, const bool wrap)
+	{
+		std::vector<uint32_t> nearby;
+		{
+			py::gil_scoped_release release;
+			for_each_near(position[0], position[1], visual_range, wrap, [&](const obj_idx id) { nearby.push_back(id); });
+		}
+		return to_numpy(std::move(nearby));
+	}
+
+
+	// find_near for every row of positions at once, as compressed rows: (offsets, rows)
+	std::pair<py::array_t<uint32_t>, py::array_t<uint32_t>> find_near_many(const Positions& positions, const float visual_range, const bool wrap)
+	{
+		const auto rows = check_positions(positions);
+		std::vector<uint32_t> offsets;
+		std::vector<uint32_t> nearby;
+		{
+			py::gil_scoped_release release;
+			offsets.reserve(static_cast<size_t>(rows.shape(0)) + 1);
+			offsets.push_back(0);
+
+			for (py::ssize_t i = 0; i < rows.shape(0); ++i)
+			{
+				for_each_near(rows(i, 0), rows(i, 1), visual_range, wrap, [&](const obj_idx id) { nearby.push_back(id); });
+				offsets.push_back(static_cast<uint32_t>(nearby.size()));
+			}
+		}
+		return { to_numpy(std::move(offsets)), to_numpy(std::move(nearby)) };
+	}
+
+
+	[[nodiscard]] std::pair<int, int> get_cell_index(const std::array<float, 2> position) const
+	{
+		return { static_cast<int>(std::floor((position[0] - origin_.x) / grid_.m_cellSize.x)),
+				 static_cast<int>(std::floor((position[1] - origin_.y) / grid_.m_cellSize.y)) };
+	}
+
+	[[nodiscard]] std::array<float, 4> get_cell_coordinates(const int i, const int j) const
+	{
+		return { origin_.x + grid_.m_cellSize.x * static_cast<float>(i), origin_.y + grid_.m_cellSize.y * static_cast<float>(j),
+				 grid_.m_cellSize.x, grid_.m_cellSize.y };
+	}
+
+	[[nodiscard]] std::pair<size_t, size_t> cells() const { return { CellsX, CellsY }; }
+
+	// particles the last update_particles() dropped because their cell was full
+	[[nodiscard]] size_t overflowed() const { return overflowed_; }
+
+private:
+	static auto check_positions(const Positions& positions)
+	{
+		if (positions.ndim() != 2 || positions.shape(1) != 2)
+			throw py::value_error("positions must have shape (n, 2)");
+		return positions.template unchecked<2>();
+	}
+
+	// wrap treats the grid as toroidal like spatial_hash_grid.py, otherwise the range is clamped to the grid
+	template<typename Func>
+	void for_each_near(const float x, const float y, const float visual_range, const bool wrap, Func&& func) const
+	{
+		if (!wrap)
+		{
+			grid_.for_each_in_rect({ x - origin_.x - visual_range, y - origin_.y - visual_range, visual_range * 2.f, visual_range * 2.f }, func);
+			return;
+		}
+
+		auto [min_x, min_y] = get_cell_index({ x - visual_range, y - visual_range });
+		auto [max_x, max_y] = get_cell_index({ x + visual_range, y + visual_range });
+
+		// a range wider than the grid would visit cells twice
+		if (max_x - min_x + 1 >= static_cast<int>(CellsX)) { min_x = 0; max_x = static_cast<int>(CellsX) - 1; }
+		if (max_y - min_y + 1 >= static_cast<int>(CellsY)) { min_y = 0; max_y = static_cast<int>(CellsY) - 1; }
+
+		for (int cell_y = min_y; cell_y <= max_y; ++cell_y)
+		{
+			const size_t wrapped_y = static_cast<size_t>((cell_y % static_cast<int>(CellsY) + static_cast<int>(CellsY)) % static_cast<int>(CellsY));
+			for (int cell_x = min_x; cell_x <= max_x; ++cell_x)
+			{
+				const size_t wrapped_x = static_cast<size_t>((cell_x % static_cast<int>(CellsX) + static_cast<int>(CellsX)) % static_cast<int>(CellsX));
+				const size_t index = wrapped_y * CellsX + wrapped_x;
+
+				for (uint8_t i = 0; i < grid_.objects_count[index]; ++i)
+				{
+					func(grid_.grid[index][i]);
+				}
+			}
+		}
+	}
+};
+
+
+template<size_t CellsX, size_t CellsY>
+void bind_grid(py::module_& module, std::map<std::pair<size_t, size_t>, GridFactory>& factories)
+{
+	using Grid = NativeGrid<CellsX, CellsY>;
+	const std::string name = "SpatialGrid" + std::to_string(CellsX) + "x" + std::to_string(CellsY);
+
+	py::class_<Grid>(module, name.c_str())
+		.def(py::init<float, float, float, float>(), py::arg("min_x"), py::arg("max_x"), py::arg("min_y"), py::arg("max_y"))
+		.def("update_particles", &Grid::update_particles, py::arg("positions"))
+		.def("find_near", &Grid::find_near, py::arg("position"), py::arg("visual_range"), py::arg("wrap") = true)
+		.def("find_near_many", &Grid::find_near_many, py::arg("positions"), py::arg("visual_range"), py::arg("wrap") = true)
+		.def("get_cell_index", &Grid::get_cell_index, py::arg("position"))
+		.def("get_cell_coordinates", &Grid::get_cell_coordinates, py::arg("i"), py::arg("j"))
+		.def_property_readonly("cells", &Grid::cells)
+		.def_property_readonly("overflowed", &Grid::overflowed);
+
+	factories[{ CellsX, CellsY }] = [](const float min_x, const float max_x, const float min_y, const float max_y)
+	{
+		return py::cast(Grid(min_x, max_x, min_y, max_y));
+	};
+}
+
+template<size_t CellsX, size_t... CellsY>
+void bind_row(py::module_& module, std::map<std::pair<size_t, size_t>, GridFactory>& factories)
+{
+	(bind_grid<CellsX, CellsY>(module, factories), ...);
+}
+
+// every CellsX by CellsY combination of the given cell counts
+template<size_t... Cells>
+void bind_grids(py::module_& module, std::map<std::pair<size_t, size_t>, GridFactory>& factories)
+{
+	(bind_row<Cells, Cells...>(module, factories), ...);
+}
+
+
+PYBIND11_MODULE(spatial_grid_native, module)
+{
+	module.doc() = "Native SpatialGrid with the SpatialHashGrid interface of spatial_hash_grid.py. "
+		"A grid must not be updated while another thread is querying it.";
+
+	static std::map<std::pair<size_t, size_t>, GridFactory> factories;
+	bind_grids<8, 16, 32, 64, 128, 256>(module, factories);
+
+	std::vector<size_t> supported_cells;
+	for (const auto& [cells, factory] : factories)
+	{
+		if (cells.first == cells.second)
+			supported_cells.push_back(cells.first);
+	}
+	module.attr("supported_cells") = supported_cells;
+
+	// same signature as create_grid in spatial_hash_grid.py
+	module.def("create_grid", [](const float width, const float height, const size_t cells_x, const size_t cells_y)
+	{
+		const auto factory = factories.find({ cells_x, cells_y });
+		if (factory == factories.end())
+			throw py::value_error("no native grid with " + std::to_string(cells_x) + "x" + std::to_string(cells_y) +
+				" cells, cell counts must be in spatial_grid_native.supported_cells");
+
+		return factory->second(0.f, width, 0.f, height);
+	}, py::arg("width"), py::arg("height"), py::arg("cells_x"), py::arg("cells_y"));
+}
@@ -30,7 +30,7 @@ class SpatialHashGrid:
                 self.cells[get_key(x, y)] = set()
 
 
-     def update_particles(self, particles, position_func):
+    def update_particles(self, particles, position_func):
         for index in self.cells:
             self.cells[index].clear()
         for particle in particles:
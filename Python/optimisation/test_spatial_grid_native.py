@@ -0,0 +1,124 @@
+"""
+compares spatial_grid_native (build it as described at the top of spatial_grid_native.cpp) with spatial_hash_grid.py
+
+    python3 -m unittest test_spatial_grid_native
+"""
+
+import unittest
+
+import numpy as np
+
+from spatial_hash_grid import create_grid
+
+try:
+    import spatial_grid_native
+except ImportError:
+    spatial_grid_native = None
+
+
+class Particle:
+    def __init__(self, row, x, y):
+        self.row = row
+        self.x = x
+        self.y = y
+        self.nearby = set()
+
+
+# (width, height, cells_x, cells_y)
+WORLDS = [(1.0, 1.0, 64, 64), (1000.0, 1000.0, 64, 64), (700.0, 500.0, 32, 16), (333.0, 200.0, 8, 128)]
+
+
+@unittest.skipIf(spatial_grid_native is None, "spatial_grid_native is not built")
+class TestSpatialGridNative(unittest.TestCase):
+    def make_world(self, width, height, cells_x, cells_y, seed):
+        rng = np.random.default_rng(seed)
+
+        # ~4 particles per cell keeps every cell well under the native grid's 24 particles per cell
+        count = cells_x * cells_y * 4
+        positions = np.empty((count, 2), dtype=np.float32)
+        positions[:, 0] = rng.uniform(0.0, width, count)
+        positions[:, 1] = rng.uniform(0.0, height, count)
+        positions[0] = (0.0, 0.0)
+        positions[1] = (np.nextafter(np.float32(width), np.float32(0)), np.nextafter(np.float32(height), np.float32(0)))
+
+        # both grids see the same float32 values
+        particles = [Particle(row, float(x), float(y)) for row, (x, y) in enumerate(positions)]
+
+        python_grid = create_grid(width, height, cells_x, cells_y)
+        python_grid.update_particles(particles, lambda particle: particle)
+
+        native_grid = spatial_grid_native.create_grid(width, height, cells_x, cells_y)
+        stored = native_grid.update_particles(positions)
+        self.assertEqual(stored, count)
+
+        return positions, particles, python_grid, native_grid
+
+    def test_cell_index_and_coordinates(self):
+        for width, height, cells_x, cells_y in WORLDS:
+            positions, _, python_grid, native_grid = self.make_world(width, height, cells_x, cells_y, 1)
+
+            for x, y in positions[:200]:
+                self.assertEqual(native_grid.get_cell_index((x, y)), python_grid.get_cell_index([float(x), float(y)]))
+
+            for i, j in [(0, 0), (cells_x - 1, cells_y - 1), (cells_x // 2, 3)]:
+                np.testing.assert_allclose(native_grid.get_cell_coordinates(i, j), python_grid.get_cell_coordinates(i, j), rtol=1e-6)
+
+    def test_find_near_wraps_like_python(self):
+        for width, height, cells_x, cells_y in WORLDS:
+            positions, particles, python_grid, native_grid = self.make_world(width, height, cells_x, cells_y, 2)
+            visual_range = min(width, height) * 0.05
+
+            for particle in particles[:300]:
+                python_grid.find_near(particle, particle, visual_range)
+                expected = {other.row for other in particle.nearby}
+
+                nearby = native_grid.find_near((particle.x, particle.y), visual_range)
+                self.assertEqual(len(nearby), len(set(nearby.tolist())), "a particle was returned twice")
+                self.assertEqual(set(nearby.tolist()), expected, f"world {width}x{height}, particle {particle.row}")
+
+    def test_find_near_many_matches_find_near(self):
+        for width, height, cells_x, cells_y in WORLDS:
+            positions, _, _, native_grid = self.make_world(width, height, cells_x, cells_y, 3)
+            visual_range = min(width, height) * 0.05
+
+            for wrap in (True, False):
+                offsets, rows = native_grid.find_near_many(positions, visual_range, wrap)
+                self.assertEqual(len(offsets), len(positions) + 1)
+
+                for i in range(0, len(positions), 7):
+                    expected = native_grid.find_near(positions[i], visual_range, wrap)
+                    self.assertEqual(rows[offsets[i]:offsets[i + 1]].tolist(), expected.tolist())
+
+    def test_find_near_without_wrap_stays_inside(self):
+        width, height, cells_x, cells_y = 1.0, 1.0, 64, 64
+        positions, _, python_grid, native_grid = self.make_world(width, height, cells_x, cells_y, 4)
+
+        # the cells overlapping the range, clamped to the grid instead of wrapped
+        position, visual_range = positions[0], 0.05
+        min_x, min_y = python_grid.get_cell_index([position[0] - visual_range, position[1] - visual_range])
+        max_x, max_y = python_grid.get_cell_index([position[0] + visual_range, position[1] + visual_range])
+        cells = {(x, y) for x in range(max(min_x, 0), min(max_x, cells_x - 1) + 1)
+                 for y in range(max(min_y, 0), min(max_y, cells_y - 1) + 1)}
+
+        expected = {row for row, (x, y) in enumerate(positions) if tuple(python_grid.get_cell_index([float(x), float(y)])) in cells}
+        self.assertEqual(set(native_grid.find_near(position, visual_range, False).tolist()), expected)
+
+    def test_outside_particles_are_skipped(self):
+        native_grid = spatial_grid_native.create_grid(10.0, 10.0, 8, 8)
+        positions = np.array([[5.0, 5.0], [-1.0, 5.0], [5.0, 10.0], [11.0, 11.0]], dtype=np.float32)
+        self.assertEqual(native_grid.update_particles(positions), 1)
+        self.assertEqual(native_grid.find_near((5.0, 5.0), 1.0).tolist(), [0])
+
+    def test_full_cell_overflow_is_counted(self):
+        native_grid = spatial_grid_native.create_grid(10.0, 10.0, 8, 8)
+        positions = np.full((30, 2), 5.0, dtype=np.float32)
+        self.assertEqual(native_grid.update_particles(positions), 24)
+        self.assertEqual(native_grid.overflowed, 6)
+        self.assertEqual(native_grid.find_near((5.0, 5.0), 0.1).tolist(), list(range(24)))
+
+        self.assertEqual(native_grid.update_particles(positions[:10]), 10)
+        self.assertEqual(native_grid.overflowed, 0)
+
+
+if __name__ == "__main__":
+    unittest.main()
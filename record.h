@@ -1,61 +1,227 @@
 #pragma once
 
 #include <SFML/Graphics.hpp>
+#include <SFML/OpenGL.hpp>
 #include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
 #include <thread>
 #include <vector>
 
+#include "Cpp/thread_pool.h"
+
 // A simple OpenCV & SFML program to record timelapses for simulations.
 // capture() will attempt to capture the current window as long as the duration > capture_rate_seconds
 // save_video() will attempt to save the video as a.mp4
+//
+// for headless runs construct it from an sf::RenderTexture (or with no source at all and feed it pixel buffers)
+// and drive it from the simulation instead of the clock: tick() returns true once every ticks_per_capture calls,
+// only then does the scene need rendering before calling capture_now() or capture_pixels()
+//
+// a headless simulation captures far faster than the workers can encode, so it runs into max_pending_frames quickly.
+// by default the capture then blocks, recording every tick at the speed of the encoder. set_drop_when_full(true)
+// instead keeps the simulation at full speed: tick() returns false while the workers are full and the frame is counted
+// in dropped_frames(). raising ticks_per_capture or worker_count keeps more frames at full speed
+//
+// capture() only reads the window back into a recycled buffer and hands it to a worker pool, the colour conversion,
+// optional downscaling and compression all happen off the render thread. frames are stored PNG-encoded
+// (deflate, lossless) which for simulation footage is roughly an order of magnitude smaller than a raw cv::Mat
+//
+// the readback is still a synchronous glReadPixels: the render thread waits for the GPU to finish the frame on every
+// capture. an asynchronous readback needs pixel buffer objects, which SFML's GL 1.1 header doesn't expose without a
+// GL loader. keep capture_rate_seconds / ticks_per_capture coarse enough that this stall doesn't matter
+//
+// at most max_pending_frames raw frames wait for the workers at once, a capture beyond that blocks until one is encoded
 class Timelapse
 {
 private:
-    sf::RenderWindow& window_;
+    sf::RenderWindow* window_ = nullptr;
+    sf::RenderTexture* render_texture_ = nullptr;
     float capture_rate_;
-    std::vector<cv::Mat> frames_;
+    unsigned ticks_per_capture_;
+    unsigned tick_count_ = 0;
+    float scale_;
+    int compression_level_;
     sf::Clock clock_;
 
+    // encoded frames, slots are reserved in capture order so workers may finish out of order
+    std::vector<std::vector<uchar>> frames_;
+    mutable std::mutex frames_mutex_;
+
+    // raw frames handed to the workers but not yet encoded, and the buffers of encoded ones kept for reuse
+    size_t max_pending_frames_;
+    size_t pending_frames_ = 0;
+    bool drop_when_full_ = false;
+    size_t dropped_frames_ = 0;
+    std::vector<std::vector<sf::Uint8>> free_buffers_;
+    std::condition_variable frame_encoded_;
+
+    // declared last so the workers are joined before the frames they write into are destroyed
+    ThreadPool workers_;
+
 public:
-    Timelapse(sf::RenderWindow& capture_window, const float capture_rate_seconds)
-	: window_(capture_window), capture_rate_(capture_rate_seconds)
-    {
-        std::cout << "OpenCV version : " << CV_VERSION << "\n";
-    }
+    // scale < 1 downsizes each frame before it is stored, compression_level is the PNG level (0-9)
+    Timelapse(sf::RenderWindow& capture_window, const float capture_rate_seconds, const float scale = 1.f,
+        const int compression_level = 1, const unsigned worker_count = 2)
+	: Timelapse(&capture_window, nullptr, capture_rate_seconds, 1, scale, compression_level, worker_count) {}
 
+    // offscreen recording, call display() on the texture before capture_now()
+    Timelapse(sf::RenderTexture& capture_texture, const unsigned ticks_per_capture, const float scale = 1.f,
+        const int compression_level = 1, const unsigned worker_count = 2)
+	: Timelapse(nullptr, &capture_texture, 0.f, ticks_per_capture, scale, compression_level, worker_count) {}
+
+    // no render source, every frame is handed over through capture_pixels()
+    explicit Timelapse(const unsigned ticks_per_capture, const float scale = 1.f,
+        const int compression_level = 1, const unsigned worker_count = 2)
+	: Timelapse(nullptr, nullptr, 0.f, ticks_per_capture, scale, compression_level, worker_count) {}
+
+    // wall-clock driven capture of the window
     void capture()
 	{
-        if (clock_.getElapsedTime().asSeconds() >= capture_rate_) 
+        if (clock_.getElapsedTime().asSeconds() >= capture_rate_)
         {
-            sf::Texture texture;
-            texture.create(window_.getSize().x, window_.getSize().y);
-            texture.update(window_);
-            const sf::Image screenshot = texture.copyToImage();
+            capture_now();
+            clock_.restart();
+        }
+    }
 
-            const auto size = static_cast<sf::Vector2i>(screenshot.getSize());
+    // simulation driven capture, call once per simulation step. returns true when this step should be recorded
+    bool tick()
+    {
+        if (++tick_count_ < ticks_per_capture_)
+            return false;
 
-            cv::Mat frame(size.y, size.x, CV_8UC4);
-            std::memcpy(frame.data, screenshot.getPixelsPtr(), size.x * size.y * 4);
-            cv::cvtColor(frame, frame, cv::COLOR_RGBA2BGR);
+        tick_count_ = 0;
 
-            frames_.push_back(frame);
-            clock_.restart();
+        // skipped here when dropping so the caller doesn't render a frame that would be thrown away
+        std::lock_guard lock(frames_mutex_);
+        if (drop_when_full_ && pending_frames_ >= max_pending_frames_)
+        {
+            ++dropped_frames_;
+            return false;
+        }
+        return true;
+    }
+
+    // unconditionally records the current contents of the window or render texture
+    void capture_now()
+    {
+        sf::Vector2u size;
+        if (window_ != nullptr && window_->setActive(true))
+        {
+            size = window_->getSize();
+        }
+        else if (render_texture_ != nullptr && render_texture_->setActive(true))
+        {
+            size = render_texture_->getSize();
+        }
+        else
+        {
+            std::cout << "Timelapse has no render source, use capture_pixels() instead." << "\n";
+            return;
         }
+
+        if (!reserve_pending_frame())
+            return;
+
+        // read straight into a recycled buffer rather than through an sf::Image, rows come out bottom-up
+        std::vector<sf::Uint8> pixels = take_buffer(size);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, static_cast<GLsizei>(size.x), static_cast<GLsizei>(size.y), GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+        submit_frame(std::move(pixels), size, true);
+    }
+
+    // records a caller-provided RGBA buffer of size.x * size.y * 4 bytes
+    void capture_pixels(const sf::Uint8* rgba_pixels, const sf::Vector2u size)
+    {
+        if (rgba_pixels == nullptr || !valid_frame(static_cast<size_t>(size.x) * size.y * 4, size))
+            return;
+
+        if (!reserve_pending_frame())
+            return;
+
+        std::vector<sf::Uint8> pixels = take_buffer(size);
+        std::copy_n(rgba_pixels, pixels.size(), pixels.data());
+        submit_frame(std::move(pixels), size, false);
+    }
+
+    // as above but takes ownership of the buffer, avoiding the copy. a buffer smaller than the frame is rejected
+    void capture_pixels(std::vector<sf::Uint8>&& rgba_pixels, const sf::Vector2u size)
+    {
+        if (!valid_frame(rgba_pixels.size(), size))
+            return;
+
+        if (!reserve_pending_frame())
+            return;
+        submit_frame(std::move(rgba_pixels), size, false);
+    }
+
+    // how many raw frames may wait for the workers before a capture blocks, each holds size.x * size.y * 4 bytes
+    void set_max_pending_frames(const size_t max_pending_frames)
+    {
+        {
+            std::lock_guard lock(frames_mutex_);
+            max_pending_frames_ = std::max<size_t>(max_pending_frames, 1);
+        }
+        frame_encoded_.notify_all();
+    }
+
+    // drop captures while the workers are full instead of blocking the caller
+    void set_drop_when_full(const bool drop_when_full)
+    {
+        {
+            std::lock_guard lock(frames_mutex_);
+            drop_when_full_ = drop_when_full;
+        }
+        frame_encoded_.notify_all();
+    }
+
+    [[nodiscard]] size_t dropped_frames() const
+    {
+        std::lock_guard lock(frames_mutex_);
+        return dropped_frames_;
     }
 
-    void save_video(const std::string& filename, const int fps = 60) const
+    // blocks until every captured frame has been converted and stored
+    void flush()
     {
+        workers_.wait();
+    }
+
+    [[nodiscard]] size_t frame_count() const
+    {
+        std::lock_guard lock(frames_mutex_);
+        return frames_.size();
+    }
+
+    // total memory held by the stored (encoded) frames
+    [[nodiscard]] size_t stored_bytes() const
+    {
+        std::lock_guard lock(frames_mutex_);
+        size_t total = 0;
+        for (const auto& frame : frames_)
+            total += frame.size();
+        return total;
+    }
+
+    void save_video(const std::string& filename, const int fps = 60)
+    {
+        flush();
+
         if (frames_.empty())
         {
             std::cout << "No frames captured. Cannot save video." << "\n";
             return;
         }
 
-        const cv::Size frame_size = frames_[0].size();
+        const cv::Size frame_size = cv::imdecode(frames_[0], cv::IMREAD_COLOR).size();
 
         // Ensure the file has a proper extension
         std::string actual_filename = filename;
-        if (actual_filename.substr(actual_filename.find_last_of(".") + 1) != "mp4") 
+        if (actual_filename.substr(actual_filename.find_last_of(".") + 1) != "mp4")
         {
             actual_filename += ".mp4";
         }
@@ -70,10 +236,10 @@ public:
         cv::VideoWriter video;
         bool success = false;
 
-        for (const auto& codec : codecs) 
+        for (const auto& codec : codecs)
         {
             video.open(actual_filename, codec, fps, frame_size);
-            if (video.isOpened()) 
+            if (video.isOpened())
             {
                 success = true;
                 break;
@@ -86,12 +252,116 @@ public:
             return;
         }
 
-        for (const auto& frame : frames_) 
+        for (const auto& encoded : frames_)
         {
+            cv::Mat frame = cv::imdecode(encoded, cv::IMREAD_COLOR);
+
+            // the window may have been resized mid-recording, the writer needs every frame at the same size
+            if (frame.size() != frame_size)
+                cv::resize(frame, frame, frame_size, 0, 0, cv::INTER_AREA);
+
             video.write(frame);
         }
 
         video.release();
         std::cout << "Video saved as " << actual_filename << "\n";
     }
+
+private:
+    Timelapse(sf::RenderWindow* window, sf::RenderTexture* render_texture, const float capture_rate_seconds,
+        const unsigned ticks_per_capture, const float scale, const int compression_level, const unsigned worker_count)
+	: window_(window), render_texture_(render_texture), capture_rate_(capture_rate_seconds),
+      ticks_per_capture_(ticks_per_capture == 0 ? 1 : ticks_per_capture), scale_(scale),
+      compression_level_(compression_level), max_pending_frames_(std::max(worker_count, 1u) * 2), workers_(worker_count)
+    {
+        std::cout << "OpenCV version : " << CV_VERSION << "\n";
+    }
+
+    // the workers read size.x * size.y * 4 bytes from the buffer
+    static bool valid_frame(const size_t buffer_size, const sf::Vector2u size)
+    {
+        if (size.x == 0 || size.y == 0 || buffer_size < static_cast<size_t>(size.x) * size.y * 4)
+        {
+            std::cout << "Timelapse frame rejected, the buffer holds " << buffer_size << " bytes but a " << size.x << "x"
+                << size.y << " RGBA frame needs " << static_cast<size_t>(size.x) * size.y * 4 << "\n";
+            return false;
+        }
+        return true;
+    }
+
+    // blocks while max_pending_frames raw frames are already waiting for the workers, or returns false when dropping
+    bool reserve_pending_frame()
+    {
+        std::unique_lock lock(frames_mutex_);
+        if (drop_when_full_ && pending_frames_ >= max_pending_frames_)
+        {
+            ++dropped_frames_;
+            return false;
+        }
+
+        frame_encoded_.wait(lock, [this] { return drop_when_full_ || pending_frames_ < max_pending_frames_; });
+        if (pending_frames_ >= max_pending_frames_)
+        {
+            ++dropped_frames_;
+            return false;
+        }
+
+        ++pending_frames_;
+        return true;
+    }
+
+    // a buffer of an already encoded frame if there is one, so steady-state capturing doesn't allocate
+    std::vector<sf::Uint8> take_buffer(const sf::Vector2u size)
+    {
+        std::vector<sf::Uint8> buffer;
+        {
+            std::lock_guard lock(frames_mutex_);
+            if (!free_buffers_.empty())
+            {
+                buffer = std::move(free_buffers_.back());
+                free_buffers_.pop_back();
+            }
+        }
+
+        buffer.resize(static_cast<size_t>(size.x) * size.y * 4);
+        return buffer;
+    }
+
+    // reserves the frame's slot and hands the raw pixels to a worker, this is all the render thread pays for
+    void submit_frame(std::vector<sf::Uint8> rgba_pixels, const sf::Vector2u size, const bool bottom_up)
+    {
+        size_t slot;
+        {
+            std::lock_guard lock(frames_mutex_);
+            slot = frames_.size();
+            frames_.emplace_back();
+        }
+
+        workers_.submit([this, slot, size, bottom_up, pixels = std::move(rgba_pixels)]() mutable
+        {
+            const cv::Mat rgba(static_cast<int>(size.y), static_cast<int>(size.x), CV_8UC4, pixels.data());
+
+            cv::Mat frame;
+            cv::cvtColor(rgba, frame, cv::COLOR_RGBA2BGR);
+
+            if (scale_ < 1.f)
+                cv::resize(frame, frame, cv::Size(), scale_, scale_, cv::INTER_AREA);
+
+            if (bottom_up)
+                cv::flip(frame, frame, 0);
+
+            std::vector<uchar> encoded;
+            cv::imencode(".png", frame, encoded, { cv::IMWRITE_PNG_COMPRESSION, compression_level_ });
+
+            {
+                std::lock_guard lock(frames_mutex_);
+                frames_[slot] = std::move(encoded);
+
+                if (free_buffers_.size() < max_pending_frames_)
+                    free_buffers_.push_back(std::move(pixels));
+                --pending_frames_;
+            }
+            frame_encoded_.notify_all();
+        });
+    }
 };